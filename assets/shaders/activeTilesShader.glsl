@@ -0,0 +1,33 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "tiles.glsl"
+
+//builds the list of tiles the multi-pass kernel has to run this tick, one invocation per tile, and
+//writes the workgroup count for glDispatchComputeIndirect. see tileAwake in tiles.glsl; painting
+//runs first, so freshly painted tiles count
+
+layout(std430, binding = 5) buffer ActiveTileBuffer
+{
+    uint activeGroupsX;
+    uint activeGroupsY;
+    uint activeGroupsZ;
+    uint activeTiles[];
+};
+
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+void main()
+{
+    ivec2 tile = ivec2(gl_GlobalInvocationID.xy);
+    if (tile.x >= tilesX() || tile.y >= tilesY())
+    {
+        return;
+    }
+
+    if (tileAwake(tile, tick))
+    {
+        uint slot = atomicAdd(activeGroupsX, 1u);
+        activeTiles[slot] = uint(tile.y * tilesX() + tile.x);
+    }
+}
@@ -0,0 +1,19 @@
+//user painting, shared by every simulation kernel. the mouse and buttons are in SimulationParams
+
+uint applyBrush(uint cell, ivec2 gID, ivec2 gridSize, uint seed)
+{
+    ivec2 clampedMouse = ivec2(clamp(mouseX, 0, gridSize.x - 1), clamp(mouseY, 0, gridSize.y - 1));
+
+    if (distance(vec2(gID), vec2(clampedMouse)) < float(brushRadius))
+    {
+        if (leftMouseDown)
+        {
+            return makeCell(MATERIAL_SAND, seed);
+        }
+        else if (rightMouseDown)
+        {
+            return makeCell(MATERIAL_WATER, seed);
+        }
+    }
+    return cell;
+}
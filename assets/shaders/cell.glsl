@@ -0,0 +1,36 @@
+//packed cell layout, one uint per cell, mirrored in main.cpp:
+//bits 0-7 material id, bits 9-10 inertia sign, bits 16-23 colour variation seed
+//(whether a cell moved this tick lives in the epoch-stamped moved bitmap, see moved.glsl)
+const uint CELL_TYPE_MASK = 0xFFu;
+const uint CELL_INERTIA_SHIFT = 9u;
+const uint CELL_INERTIA_MASK = 3u << CELL_INERTIA_SHIFT;
+const uint CELL_SEED_SHIFT = 16u;
+const uint CELL_SEED_MASK = 0xFFu << CELL_SEED_SHIFT;
+
+uint makeCell(uint type, uint seed)
+{
+    return (type & CELL_TYPE_MASK) | ((seed << CELL_SEED_SHIFT) & CELL_SEED_MASK);
+}
+
+uint cellType(uint cell)
+{
+    return cell & CELL_TYPE_MASK;
+}
+
+uint cellSeed(uint cell)
+{
+    return (cell & CELL_SEED_MASK) >> CELL_SEED_SHIFT;
+}
+
+//inertia is stored as a sign: 0 = none, 1 = right, 2 = left
+int cellInertia(uint cell)
+{
+    uint bits = (cell & CELL_INERTIA_MASK) >> CELL_INERTIA_SHIFT;
+    return bits == 1u ? 1 : (bits == 2u ? -1 : 0);
+}
+
+uint withInertia(uint cell, int inertia)
+{
+    uint bits = inertia > 0 ? 1u : (inertia < 0 ? 2u : 0u);
+    return (cell & ~CELL_INERTIA_MASK) | (bits << CELL_INERTIA_SHIFT);
+}
@@ -0,0 +1,46 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "tiles.glsl"
+
+//writes the colour of every cell in the tiles that changed since the last colour pass into a grid
+//sized RGBA8 image, which the fragment shader samples. one workgroup per tile, only dispatched over
+//the tiles the camera can see (starting at firstTile); unchanged tiles return straight away and
+//changed ones are counted so the host can skip presenting idle frames
+
+//tiles recoloured since the host last read it back
+layout(std430, binding = 7) buffer DirtyTileBuffer
+{
+    uint dirtyTiles;
+};
+
+layout(rgba8, binding = 0) uniform writeonly image2D colourImage;
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+//first tick not yet written to the image, 0 recolours everything
+uniform uint colourSince;
+
+uniform ivec2 firstTile;
+
+void main()
+{
+    ivec2 tile = firstTile + ivec2(gl_WorkGroupID.xy);
+    if (tileStamp[tile.y * tilesX() + tile.x] < colourSince)
+    {
+        return;
+    }
+
+    if (gl_LocalInvocationIndex == 0u)
+    {
+        atomicAdd(dirtyTiles, 1u);
+    }
+
+    //the image is padded to whole tiles, the padding is kept clear so the pyramid's edge texels only
+    //average in empty space
+    ivec2 gID = tile * TILE_SIZE + ivec2(gl_LocalInvocationID.xy);
+    imageStore(colourImage, gID, insideGrid(gID) ? cellColour(loadCell(gID)) : vec4(0.0));
+}
@@ -1,249 +1,218 @@
 #version 430 core
 
-struct Cell
-{
-    vec4 colour;
-    int type;
-    int justMoved;
-    int density;
-    int inertia;
-};
-
-layout(std430, binding = 0) buffer GridBuffer
-{
-    Cell grid[];
-};
-
-layout(std430, binding = 1) buffer nextGridBuffer
-{
-    Cell nextGrid[];
-};
-
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "stamps.glsl"
+#include "tiles.glsl"
+#include "moved.glsl"
+#include "hash.glsl"
+
+//multi-pass kernel: updates the grid in place, a move claims both its source and destination so
+//no other invocation can read or write either cell for the rest of the tick
+//epoch-stamped bitmap, see stamps.glsl
 layout(std430, binding = 2) buffer claimBuffer
 {
-    int claim[];
+    uint claim[];
 };
 
-layout(std430, binding = 3) buffer movedBuffer
+//cells to run when liveCellsOnly is set, one invocation per entry (see liveCellsShader.glsl)
+layout(std430, binding = 6) buffer LiveCellBuffer
 {
-    int moved[];
+    uint liveGroupsX;
+    uint liveGroupsY;
+    uint liveGroupsZ;
+    uint liveCount;
+    uint liveCells[];
 };
 
 layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
 
-uniform int pass;
-
-uniform float time;
-
-uniform int gridWidth;
-uniform int gridHeight;
-
-uniform int mouseX;
-uniform int mouseY;
+//PASS is defined by main.cpp, which builds one program per pass (0 gravity, 1 diagonal, 2 horizontal),
+//so each program only carries its own pass's movement step and material test
+#ifndef PASS
+#error PASS must be defined
+#endif
 
-uniform bool leftMouseDown;
-uniform bool rightMouseDown;
+uniform bool liveCellsOnly;
 
-Cell Air = Cell(vec4(0.0, 0.0, 0.0, 0.0), 0, 0, 0, 0);
-Cell Sand = Cell(vec4(1.0, 1.0, 0.0, 1.0), 1, 0, 10, 0);
-Cell Water = Cell(vec4(0.0, 0.0, 1.0, 1.0), 2, 0, 5, 0);
-
-uint hash(uint x)
+//returns true if this invocation set the claim flag, i.e. nobody claimed the cell earlier this tick
+bool claimCell(uint IDx)
 {
-    x ^= x >> 16;
-    x *= 0x7feb352d;
-    x ^= x >> 15;
-    x *= 0x846ca68b;
-    x ^= x >> 16;
-    return x;
-}
-
-float random(uint seed)
-{
-    return float(hash(seed)) / float(0xffffffff);
+    uint word = stampWord(IDx);
+    uint expected = claim[word];
+    uint desired;
+    while (stampSet(expected, IDx, desired))
+    {
+        uint result = atomicCompSwap(claim[word], expected, desired);
+        if (result == expected)
+        {
+            return true;
+        }
+        expected = result;
+    }
+    return false;
 }
 
-bool inBounds(uint IDx)
+//only valid for a claim this invocation holds, whose word is therefore stamped with the current epoch
+void releaseClaim(uint IDx)
 {
-    return IDx < uint(gridWidth * gridHeight);
+    atomicAnd(claim[stampWord(IDx)], ~stampBit(IDx));
 }
 
-bool tryClaimAndMove(uint source, uint destination, Cell cell)
+bool tryClaimAndMove(ivec2 sourcePos, ivec2 destinationPos, uint cell)
 {
-    if (!inBounds(destination) || destination == source)
+    if (!insideGrid(destinationPos) || destinationPos == sourcePos)
     {
         return false;
     }
 
-    Cell destCell = grid[destination];
-
-    if (destCell.density >= cell.density)
+    //cheap early out before touching the claim words
+    if (cellDensity(loadCell(destinationPos)) >= cellDensity(cell))
     {
         return false;
     }
 
-    int expected = -1;
-    int result = atomicCompSwap(claim[destination], expected, int(source));
-    if (result == expected)
+    uint source = cellIndex(sourcePos);
+    uint destination = cellIndex(destinationPos);
+    if (!claimCell(source))
     {
-        nextGrid[destination] = cell;
-        nextGrid[destination].justMoved = 1;
-
-        nextGrid[source] = destCell;
-        nextGrid[source].justMoved = 0;
-
-        moved[source] = 1;
-        moved[destination] = 1;
-        return true;
+        return false;
     }
-    return false;
-}
-
-void main()
-{
-    ivec2 gID = ivec2(gl_GlobalInvocationID.xy);
-    uint IDx = gID.y * gridWidth + gID.x;
-
-    if (!inBounds(IDx))
+    if (!claimCell(destination))
     {
-        return;
+        releaseClaim(source);
+        return false;
     }
 
-    Cell currentCell = grid[IDx];
-
-    //user painting
-    ivec2 clampedMouse = ivec2(clamp(mouseX, 0, gridWidth - 1), clamp(mouseY, 0, gridHeight - 1));
-
-    if (pass == 0)
+    //both cells are ours now, nobody else can have changed them
+    uint destCell = loadCell(destinationPos);
+    if (cellDensity(destCell) >= cellDensity(cell))
     {
-        if (IDx < uint((gridWidth * gridHeight)))
-        {
-            claim[IDx] = -1;
-            moved[IDx] = 0;
-        }
+        releaseClaim(source);
+        releaseClaim(destination);
+        return false;
     }
 
-    //paint pass
-    else if (pass == 1)
-    {
-        int radius = 4;
+    storeCell(destinationPos, cell);
+    storeCell(sourcePos, destCell);
 
-        nextGrid[IDx] = currentCell;
-        nextGrid[IDx].justMoved = 0;
+    markMoved(source);
+    markMoved(destination);
+    return true;
+}
 
-        if (distance(vec2(gID), vec2(clampedMouse)) < float(radius))
+void main()
+{
+    ivec2 gID = ivec2(gl_GlobalInvocationID.xy);
+    if (liveCellsOnly)
+    {
+        uint entry = gl_WorkGroupID.x * gl_WorkGroupSize.x * gl_WorkGroupSize.y + gl_LocalInvocationIndex;
+        if (entry >= liveCount)
         {
-            if (leftMouseDown)
-            {
-                nextGrid[IDx] = Sand;
-            }
-            else if (rightMouseDown)
-            {
-                nextGrid[IDx] = Water;
-            }
+            return;
         }
+        gID = cellPosition(liveCells[entry]);
     }
 
-    else if (currentCell.justMoved == 1)
+    if (!insideGrid(gID))
     {
         return;
     }
 
-    else if (pass >= 2 && moved[IDx] == 1)
+    uint IDx = cellIndex(gID);
+
+    uint currentCell = loadCell(gID);
+
+    if (hasMoved(IDx))
     {
         return;
     }
 
+#if PASS == 0
     //gravity pass
-    else if (pass == 2 && currentCell.type != 0)
+    else if (cellMovement(currentCell) != MOVEMENT_STATIC)
     {
-        uint down = IDx;
-        if (gID.y > 0)
-        {
-            down = IDx - gridWidth;
-            tryClaimAndMove(IDx, down, currentCell);
-        }
+        tryClaimAndMove(gID, gID + ivec2(0, -1), currentCell);
     }
 
+#elif PASS == 1
     //diagonal movement pass
-    else if (pass == 3 && currentCell.type == 1)
+    else if (cellMovement(currentCell) == MOVEMENT_POWDER)
     {
-        uint downLeft = IDx;
-        uint downRight = IDx;
-
-        if (gID.x > 0 && gID.y > 0)
-        {
-            downLeft = IDx - gridWidth - 1;
-        }
-        if (gID.x < gridWidth - 1 && gID.y > 0)
-        {
-            downRight = IDx - gridWidth + 1;
-        }
+        //tryClaimAndMove rejects destinations outside the grid
+        ivec2 downLeft = gID + ivec2(-1, -1);
+        ivec2 downRight = gID + ivec2(1, -1);
 
         bool preferRight = ((hash(IDx) & 1u) == 0u);
         if (preferRight)
         {
-            if (!tryClaimAndMove(IDx, downRight, currentCell))
+            if (!tryClaimAndMove(gID, downRight, currentCell))
             {
-                tryClaimAndMove(IDx, downLeft, currentCell);
+                tryClaimAndMove(gID, downLeft, currentCell);
             }
         }
         else
         {
-            if (!tryClaimAndMove(IDx, downLeft, currentCell))
+            if (!tryClaimAndMove(gID, downLeft, currentCell))
             {
-                tryClaimAndMove(IDx, downRight, currentCell);
+                tryClaimAndMove(gID, downRight, currentCell);
             }
         }
     }
 
+#elif PASS == 2
     //horizontal movement pass
-    else if (pass == 4 && currentCell.type == 2)
+    else if (cellMovement(currentCell) == MOVEMENT_LIQUID)
     {
-        uint left = IDx;
-        uint right = IDx;
+        //a side that isn't open air stays at gID, which tryClaimAndMove rejects
+        ivec2 left = gID;
+        ivec2 right = gID;
 
-        if (gID.x > 0 && grid[IDx - 1].type == 0)
+        if (gID.x > 0 && cellType(loadCell(gID + ivec2(-1, 0))) == MATERIAL_AIR)
         {
-            left = IDx - 1;
+            left = gID + ivec2(-1, 0);
         }
-        if (gID.x < gridWidth - 1 && grid[IDx + 1].type == 0)
+        if (gID.x < gridWidth - 1 && cellType(loadCell(gID + ivec2(1, 0))) == MATERIAL_AIR)
         {
-            right = IDx + 1;
+            right = gID + ivec2(1, 0);
         }
 
-        if (currentCell.inertia == 1)
+        int inertia = cellInertia(currentCell);
+        if (inertia == 1)
         {
-            if (!tryClaimAndMove(IDx, right, currentCell))
+            if (!tryClaimAndMove(gID, right, currentCell))
             {
-                tryClaimAndMove(IDx, left, currentCell);
+                tryClaimAndMove(gID, left, currentCell);
             }
         }
-        else if (currentCell.inertia == -1)
+        else if (inertia == -1)
         {
-            if (!tryClaimAndMove(IDx, left, currentCell))
+            if (!tryClaimAndMove(gID, left, currentCell))
             {
-                tryClaimAndMove(IDx, right, currentCell);
+                tryClaimAndMove(gID, right, currentCell);
             }
         }
         else
         {
-            bool preferRight = ((hash(IDx + uint(pass) + uint(time * 997.0)) & 1u) == 0u);
+            bool preferRight = ((hash(IDx + uint(PASS) + tick * 997u) & 1u) == 0u);
             if (preferRight)
             {
-                if (!tryClaimAndMove(IDx, right, currentCell))
+                if (!tryClaimAndMove(gID, right, currentCell))
                 {
-                    tryClaimAndMove(IDx, left, currentCell);
+                    tryClaimAndMove(gID, left, currentCell);
                 }
             }
             else
             {
-                if (!tryClaimAndMove(IDx, left, currentCell))
+                if (!tryClaimAndMove(gID, left, currentCell))
                 {
-                    tryClaimAndMove(IDx, right, currentCell);
+                    tryClaimAndMove(gID, right, currentCell);
                 }
             }
         }
     }
+#endif
 }
 
@@ -0,0 +1,47 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "tiles.glsl"
+
+//builds one level of the colour image's mip pyramid from the level below it, box filtering 2x2
+//texels. like the colour pass, one workgroup per visible tile and only for tiles that changed, a
+//tile covers TILE_SIZE >> level texels per axis so the pyramid stops at one texel per tile
+
+layout(rgba8, binding = 0) uniform readonly image2D sourceLevel;
+layout(rgba8, binding = 1) uniform writeonly image2D destinationLevel;
+
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+uniform uint colourSince;
+
+uniform ivec2 firstTile;
+
+//level being written, 1 or more
+uniform int level;
+
+void main()
+{
+    ivec2 tile = firstTile + ivec2(gl_WorkGroupID.xy);
+    if (tileStamp[tile.y * tilesX() + tile.x] < colourSince)
+    {
+        return;
+    }
+
+    int tileTexels = TILE_SIZE >> level;
+    ivec2 lID = ivec2(gl_LocalInvocationID.xy);
+    ivec2 texel = tile * tileTexels + lID;
+    if (lID.x >= tileTexels || lID.y >= tileTexels || any(greaterThanEqual(texel, imageSize(destinationLevel))))
+    {
+        return;
+    }
+
+    //the image is padded to whole tiles, so every level is exactly twice the size of the next and
+    //the 2x2 source texels are always inside the level below
+    ivec2 source = texel * 2;
+    vec4 colour = imageLoad(sourceLevel, source)
+                + imageLoad(sourceLevel, source + ivec2(1, 0))
+                + imageLoad(sourceLevel, source + ivec2(0, 1))
+                + imageLoad(sourceLevel, source + ivec2(1, 1));
+
+    imageStore(destinationLevel, texel, colour * 0.25);
+}
@@ -1,51 +1,56 @@
 #version 430 core
 
-struct Cell
-{
-    vec4 colour;
-    int type;
-    int justMoved;
-    int density;
-    int inertia;
-};
-
-layout(std430, binding = 0) buffer GridBuffer
-{
-    Cell grid[];
-};
+#include "grid.glsl"
+#include "stamps.glsl"
+#include "tileDebug.glsl"
 
+//epoch-stamped bitmap, see stamps.glsl
 layout(std430, binding = 3) buffer movedBuffer
 {
-    int moved[];
+    uint moved[];
 };
 
-uniform bool debug;
+//mirrors DebugView in main.cpp
+const int DEBUG_NONE = 0;
+const int DEBUG_MOVED = 1;
+const int DEBUG_ACTIVITY = 2;
+const int DEBUG_TILES = 3;
+
+uniform int debugView;
 
-uniform int gridWidth;
-uniform int gridHeight;
-uniform int screenWidth;
-uniform int screenHeight;
+//cell colours at grid resolution, written by colourShader.glsl, with a mip pyramid built by
+//downsampleShader.glsl. colourLevel is chosen by the host so one texel is about one pixel
+layout(binding = 0) uniform sampler2D colourTexture;
+uniform int colourLevel;
+
+//grid position of the bottom left screen pixel, and screen pixels per cell
+uniform vec2 cameraOrigin;
+uniform float cameraZoom;
 
 out vec4 FragColour;
 
+//black to red to yellow to white
+vec3 heatColour(float heat)
+{
+    return clamp(vec3(heat * 3.0, heat * 3.0 - 1.0, heat * 3.0 - 2.0), 0.0, 1.0);
+}
+
 void main()
 {
-    vec2 uv = gl_FragCoord.xy / vec2(screenWidth, screenHeight);
-    ivec2 gID = ivec2(uv * vec2(gridWidth, gridHeight));
+    ivec2 gID = ivec2(floor(cameraOrigin + gl_FragCoord.xy / cameraZoom));
 
-    if (gID.x >= gridWidth || gID.y >= gridHeight)
+    if (!insideGrid(gID))
     {
         discard;
     }
 
-    uint IDx = gID.y * gridWidth + gID.x;
-
-    Cell currentCell = grid[IDx];
+    vec4 cellColour = texelFetch(colourTexture, gID >> colourLevel, colourLevel);
 
     //debug view which shows which cells have moved in the last frame
-    if (debug)
+    if (debugView == DEBUG_MOVED)
     {
-        if (moved[IDx] == 1)
+        uint IDx = cellIndex(gID);
+        if (stampIsSet(moved[stampWord(IDx)], IDx))
         {
             FragColour = vec4(1.0, 0.0, 0.0, 1.0);
         }
@@ -54,9 +59,40 @@ void main()
             FragColour = vec4(0.0);
         }
     }
+    //where cells kept moving recently, over a dimmed grid. the square root lifts small amounts of activity
+    else if (debugView == DEBUG_ACTIVITY)
+    {
+        float activity = tileDebug[tileIndex(gID)].activity;
+        FragColour = vec4(cellColour.rgb * 0.3 + heatColour(sqrt(activity)), 1.0);
+    }
+    //tile states tinted over the grid, brighter for tiles whose workgroups did more work, with tile borders
+    else if (debugView == DEBUG_TILES)
+    {
+        TileDebug stats = tileDebug[tileIndex(gID)];
+
+        vec3 stateColour = vec3(0.15);
+        if (stats.state == TILE_STATE_ACTIVE)
+        {
+            stateColour = vec3(0.8, 0.1, 0.1);
+        }
+        else if (stats.state == TILE_STATE_SLEEPING)
+        {
+            stateColour = vec3(0.1, 0.5, 0.1);
+        }
+
+        float cost = float(stats.cost) / float(TILE_SIZE * TILE_SIZE);
+        vec3 colour = mix(cellColour.rgb, stateColour * (0.4 + 0.6 * cost), 0.6);
+
+        ivec2 local = gID % TILE_SIZE;
+        if (cameraZoom >= 2.0 && (local.x == 0 || local.y == 0))
+        {
+            colour *= 0.5;
+        }
+        FragColour = vec4(colour, 1.0);
+    }
     //default view
     else
     {
-        FragColour = vec4(currentCell.colour);
+        FragColour = cellColour;
     }
 }
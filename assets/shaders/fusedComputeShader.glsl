@@ -0,0 +1,161 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "stamps.glsl"
+#include "tiles.glsl"
+#include "moved.glsl"
+#include "hash.glsl"
+#include "brush.glsl"
+
+//fused simulation kernel: each workgroup loads its 16x16 tile into shared memory once, runs the
+//paint, gravity, diagonal and horizontal steps on it with workgroup barriers in between and writes
+//it back in place once. cells never leave their tile within a tick, so no halo is needed; instead the tile
+//grid is shifted by half a tile on every other tick (tileOffset) so no tile edge stays a wall
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+uniform int tileOffset;
+
+shared uint tile[TILE_SIZE * TILE_SIZE];
+//non-zero once a tile cell has been claimed this tick; cells outside the grid start claimed so nothing moves into them
+shared uint tileClaim[TILE_SIZE * TILE_SIZE];
+
+bool claimTileCell(uint local)
+{
+    return atomicCompSwap(tileClaim[local], 0u, 1u) == 0u;
+}
+
+//claims both ends so a cell can't be moved into while it is moving out, then swaps them in place
+bool tryMoveInTile(uint source, uint destination)
+{
+    if (!claimTileCell(source))
+    {
+        return false;
+    }
+    if (!claimTileCell(destination))
+    {
+        tileClaim[source] = 0u;
+        return false;
+    }
+
+    uint cell = tile[source];
+    uint destCell = tile[destination];
+
+    if (cellDensity(destCell) >= cellDensity(cell))
+    {
+        tileClaim[source] = 0u;
+        tileClaim[destination] = 0u;
+        return false;
+    }
+
+    tile[destination] = cell;
+    tile[source] = destCell;
+    return true;
+}
+
+void tileStep()
+{
+    memoryBarrierShared();
+    barrier();
+}
+
+void main()
+{
+    ivec2 lID = ivec2(gl_LocalInvocationID.xy);
+    uint local = gl_LocalInvocationIndex;
+
+    ivec2 gID = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - ivec2(tileOffset) + lID;
+    bool inGrid = gID.x >= 0 && gID.y >= 0 && gID.x < gridWidth && gID.y < gridHeight;
+    uint IDx = cellIndex(gID);
+
+    //load + paint
+    if (inGrid)
+    {
+        uint seed = hash(IDx ^ tick);
+        uint loaded = loadCell(gID);
+        tile[local] = applyBrush(loaded, gID, ivec2(gridWidth, gridHeight), seed);
+        tileClaim[local] = 0u;
+        if (tile[local] != loaded)
+        {
+            markTileActive(IDx);
+        }
+    }
+    else
+    {
+        tile[local] = makeCell(MATERIAL_AIR, 0u);
+        tileClaim[local] = 1u;
+    }
+    tileStep();
+
+    //gravity
+    uint currentCell = tile[local];
+    if (tileClaim[local] == 0u && cellMovement(currentCell) != MOVEMENT_STATIC && lID.y > 0)
+    {
+        tryMoveInTile(local, local - TILE_SIZE);
+    }
+    tileStep();
+
+    //diagonal movement (powders)
+    currentCell = tile[local];
+    if (tileClaim[local] == 0u && cellMovement(currentCell) == MOVEMENT_POWDER && lID.y > 0)
+    {
+        bool canLeft = lID.x > 0;
+        bool canRight = lID.x < TILE_SIZE - 1;
+
+        bool preferRight = ((hash(IDx) & 1u) == 0u);
+        if (preferRight)
+        {
+            if (!(canRight && tryMoveInTile(local, local - TILE_SIZE + 1)) && canLeft)
+            {
+                tryMoveInTile(local, local - TILE_SIZE - 1);
+            }
+        }
+        else
+        {
+            if (!(canLeft && tryMoveInTile(local, local - TILE_SIZE - 1)) && canRight)
+            {
+                tryMoveInTile(local, local - TILE_SIZE + 1);
+            }
+        }
+    }
+    tileStep();
+
+    //horizontal movement (liquids)
+    currentCell = tile[local];
+    if (tileClaim[local] == 0u && cellMovement(currentCell) == MOVEMENT_LIQUID)
+    {
+        bool canLeft = lID.x > 0 && cellType(tile[local - 1]) == MATERIAL_AIR;
+        bool canRight = lID.x < TILE_SIZE - 1 && cellType(tile[local + 1]) == MATERIAL_AIR;
+
+        int inertia = cellInertia(currentCell);
+        bool preferRight = inertia == 0 ? ((hash(IDx + tick * 997u) & 1u) == 0u) : inertia == 1;
+        if (preferRight)
+        {
+            if (!(canRight && tryMoveInTile(local, local + 1)) && canLeft)
+            {
+                tryMoveInTile(local, local - 1);
+            }
+        }
+        else
+        {
+            if (!(canLeft && tryMoveInTile(local, local - 1)) && canRight)
+            {
+                tryMoveInTile(local, local + 1);
+            }
+        }
+    }
+    tileStep();
+
+    //write back
+    if (inGrid)
+    {
+        storeCell(gID, tile[local]);
+        if (tileClaim[local] != 0u)
+        {
+            markMoved(IDx);
+        }
+    }
+}
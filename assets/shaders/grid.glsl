@@ -0,0 +1,69 @@
+#include "simulationParams.glsl"
+
+//grid dimensions (from SimulationParams) and the 16x16 tiles used for workgroups, activity
+//tracking and the memory layout
+
+const int TILE_SIZE = 16;
+
+int tilesX()
+{
+    return (gridWidth + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+int tilesY()
+{
+    return (gridHeight + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+bool insideGrid(ivec2 gID)
+{
+    return gID.x >= 0 && gID.y >= 0 && gID.x < gridWidth && gID.y < gridHeight;
+}
+
+uint tileIndex(ivec2 gID)
+{
+    return uint((gID.y / TILE_SIZE) * tilesX() + gID.x / TILE_SIZE);
+}
+
+ivec2 tileOrigin(uint tile)
+{
+    return ivec2(int(tile) % tilesX(), int(tile) / tilesX()) * TILE_SIZE;
+}
+
+//cells are stored tile by tile, TILE_SIZE * TILE_SIZE cells each, in Morton order within the tile, so
+//vertical and diagonal neighbours mostly share a cache line and a workgroup's tile is contiguous.
+//mirrored in main.cpp, which sizes the buffers for whole tiles
+uint gridCells()
+{
+    return uint(tilesX() * tilesY() * TILE_SIZE * TILE_SIZE);
+}
+
+//spreads the low 4 bits of v to the even bits
+uint mortonSpread(uint v)
+{
+    v &= 0x0Fu;
+    v = (v | (v << 2)) & 0x33u;
+    v = (v | (v << 1)) & 0x55u;
+    return v;
+}
+
+//gathers the even bits of v back into the low 4 bits
+uint mortonCompact(uint v)
+{
+    v &= 0x55u;
+    v = (v | (v >> 1)) & 0x33u;
+    v = (v | (v >> 2)) & 0x0Fu;
+    return v;
+}
+
+uint cellIndex(ivec2 gID)
+{
+    uint local = mortonSpread(uint(gID.x)) | (mortonSpread(uint(gID.y)) << 1);
+    return tileIndex(gID) * uint(TILE_SIZE * TILE_SIZE) + local;
+}
+
+ivec2 cellPosition(uint IDx)
+{
+    uint local = IDx % uint(TILE_SIZE * TILE_SIZE);
+    return tileOrigin(IDx / uint(TILE_SIZE * TILE_SIZE)) + ivec2(mortonCompact(local), mortonCompact(local >> 1));
+}
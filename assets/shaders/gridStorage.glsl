@@ -0,0 +1,36 @@
+//where the packed grid lives (see grid.glsl, which must be included first). by default an SSBO in
+//cellIndex order; with GRID_IMAGE defined an r32ui image at grid resolution, so neighbour reads go
+//through the texture cache's 2D tiling. kernels only touch the grid through loadCell and storeCell
+#ifdef GRID_IMAGE
+
+//image unit mirrored in main.cpp (GRID_IMAGE_UNIT)
+layout(r32ui, binding = 2) uniform coherent uimage2D gridImage;
+
+uint loadCell(ivec2 gID)
+{
+    return imageLoad(gridImage, gID).r;
+}
+
+void storeCell(ivec2 gID, uint cell)
+{
+    imageStore(gridImage, gID, uvec4(cell));
+}
+
+#else
+
+layout(std430, binding = 0) buffer GridBuffer
+{
+    uint grid[];
+};
+
+uint loadCell(ivec2 gID)
+{
+    return grid[cellIndex(gID)];
+}
+
+void storeCell(ivec2 gID, uint cell)
+{
+    grid[cellIndex(gID)] = cell;
+}
+
+#endif
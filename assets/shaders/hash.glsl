@@ -0,0 +1,14 @@
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(uint seed)
+{
+    return float(hash(seed)) / float(0xffffffff);
+}
@@ -0,0 +1,74 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+
+//stream compaction: one workgroup per active tile (dispatched with the active tile list's indirect
+//arguments) writes the indices of its movable cells to a compact list. a prefix sum over the tile
+//gives each live cell its slot, so the tile only needs one global atomic to reserve its range.
+//the list is prefixed by the workgroup count the movement passes are dispatched with
+
+layout(std430, binding = 5) buffer ActiveTileBuffer
+{
+    uint activeGroupsX;
+    uint activeGroupsY;
+    uint activeGroupsZ;
+    uint activeTiles[];
+};
+
+layout(std430, binding = 6) buffer LiveCellBuffer
+{
+    uint liveGroupsX;
+    uint liveGroupsY;
+    uint liveGroupsZ;
+    uint liveCount;
+    uint liveCells[];
+};
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+const uint TILE_CELLS = 256u;
+
+shared uint scan[TILE_CELLS];
+shared uint tileBase;
+
+void main()
+{
+    uint local = gl_LocalInvocationIndex;
+    //invocations walk the tile in memory order, so the list comes out sorted by address
+    uint IDx = activeTiles[gl_WorkGroupID.x] * TILE_CELLS + local;
+    ivec2 gID = cellPosition(IDx);
+
+    //air and static cells never start a move, so they don't need an invocation in the movement passes
+    bool live = insideGrid(gID) && cellMovement(loadCell(gID)) != MOVEMENT_STATIC;
+    scan[local] = live ? 1u : 0u;
+    barrier();
+
+    //inclusive Hillis-Steele scan, read and write separated by barriers
+    for (uint offset = 1u; offset < TILE_CELLS; offset <<= 1)
+    {
+        uint value = local >= offset ? scan[local - offset] : 0u;
+        barrier();
+        scan[local] += value;
+        barrier();
+    }
+
+    //the last element holds the tile's total
+    if (local == TILE_CELLS - 1u)
+    {
+        uint total = scan[local];
+        tileBase = atomicAdd(liveCount, total);
+        if (total > 0u)
+        {
+            atomicMax(liveGroupsX, (tileBase + total + TILE_CELLS - 1u) / TILE_CELLS);
+        }
+    }
+    barrier();
+
+    if (live)
+    {
+        liveCells[tileBase + scan[local] - 1u] = IDx;
+    }
+}
@@ -0,0 +1,143 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "stamps.glsl"
+#include "tiles.glsl"
+#include "moved.glsl"
+#include "hash.glsl"
+#include "brush.glsl"
+
+//margolus neighbourhood kernel: each invocation owns one 2x2 block and applies the movement rules
+//inside it in place, so no two invocations ever touch the same cell and moving needs no claims or atomics.
+//markMoved still sets its bit with an atomic, as one moved bitmap word covers cells of several blocks.
+//the block grid is offset by one cell on every other tick (blockOffset) so cells can cross block edges
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+uniform int blockOffset;
+
+//block cells, indexed bottom-left, bottom-right, top-left, top-right
+const ivec2 blockCellOffsets[4] = ivec2[4](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+
+uint block[4];
+bool blockInGrid[4];
+bool blockMoved[4];
+
+bool tryMoveInBlock(int source, int destination)
+{
+    if (!blockInGrid[destination] || blockMoved[source] || blockMoved[destination])
+    {
+        return false;
+    }
+    if (cellDensity(block[destination]) >= cellDensity(block[source]))
+    {
+        return false;
+    }
+
+    uint cell = block[source];
+    block[source] = block[destination];
+    block[destination] = cell;
+    blockMoved[source] = true;
+    blockMoved[destination] = true;
+    return true;
+}
+
+//liquids keep moving the way they last moved; once blocked they lose their inertia and pick a side at random
+void flowInBlock(int left, int right, uint seed)
+{
+    int liquid = cellMovement(block[left]) == MOVEMENT_LIQUID && !blockMoved[left] ? left :
+                 cellMovement(block[right]) == MOVEMENT_LIQUID && !blockMoved[right] ? right : -1;
+    if (liquid < 0)
+    {
+        return;
+    }
+
+    int direction = liquid == left ? 1 : -1;
+    int inertia = cellInertia(block[liquid]);
+    if (inertia == -direction || (inertia == 0 && (seed & 1u) == 0u))
+    {
+        return;
+    }
+
+    int other = liquid == left ? right : left;
+    if (cellType(block[other]) == MATERIAL_AIR && tryMoveInBlock(liquid, other))
+    {
+        block[other] = withInertia(block[other], direction);
+    }
+    else
+    {
+        block[liquid] = withInertia(block[liquid], 0);
+    }
+}
+
+void main()
+{
+    ivec2 origin = ivec2(gl_GlobalInvocationID.xy) * 2 - ivec2(blockOffset);
+    ivec2 gridSize = ivec2(gridWidth, gridHeight);
+    uint blockSeed = hash(uint(origin.y * gridWidth + origin.x) ^ hash(tick));
+
+    //load + paint; cells outside the grid act as walls
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 gID = origin + blockCellOffsets[i];
+        blockInGrid[i] = gID.x >= 0 && gID.y >= 0 && gID.x < gridWidth && gID.y < gridHeight;
+        blockMoved[i] = false;
+        block[i] = makeCell(MATERIAL_AIR, 0u);
+        if (blockInGrid[i])
+        {
+            uint IDx = cellIndex(gID);
+            uint loaded = loadCell(gID);
+            block[i] = applyBrush(loaded, gID, gridSize, hash(IDx ^ tick));
+            if (block[i] != loaded)
+            {
+                markTileActive(IDx);
+            }
+        }
+    }
+    if (!blockInGrid[0] && !blockInGrid[1] && !blockInGrid[2] && !blockInGrid[3])
+    {
+        return;
+    }
+
+    //gravity
+    for (int column = 0; column < 2; column++)
+    {
+        if (blockInGrid[column + 2] && cellMovement(block[column + 2]) != MOVEMENT_STATIC)
+        {
+            tryMoveInBlock(column + 2, column);
+        }
+    }
+
+    //diagonal movement (powders), top-left to bottom-right and top-right to bottom-left in random order
+    int first = (blockSeed & 2u) == 0u ? 2 : 3;
+    for (int i = 0; i < 2; i++)
+    {
+        int top = i == 0 ? first : 5 - first;
+        if (blockInGrid[top] && cellMovement(block[top]) == MOVEMENT_POWDER)
+        {
+            tryMoveInBlock(top, 3 - top);
+        }
+    }
+
+    //horizontal movement (liquids)
+    flowInBlock(0, 1, blockSeed >> 2);
+    flowInBlock(2, 3, blockSeed >> 3);
+
+    //write back
+    for (int i = 0; i < 4; i++)
+    {
+        if (blockInGrid[i])
+        {
+            ivec2 gID = origin + blockCellOffsets[i];
+            uint IDx = cellIndex(gID);
+            storeCell(gID, block[i]);
+            if (blockMoved[i])
+            {
+                markMoved(IDx);
+            }
+        }
+    }
+}
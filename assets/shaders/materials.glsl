@@ -0,0 +1,47 @@
+//material property table, mirrored in src/material/Material.h
+const uint MATERIAL_AIR = 0u;
+const uint MATERIAL_SAND = 1u;
+const uint MATERIAL_WATER = 2u;
+
+const int MOVEMENT_STATIC = 0;
+const int MOVEMENT_POWDER = 1;
+const int MOVEMENT_LIQUID = 2;
+
+const int MATERIAL_FLAG_VARIATION = 1;
+
+struct Material
+{
+    vec4 colour;
+    int density;
+    int movement;
+    int flags;
+    int padding;
+};
+
+layout(std140, binding = 0) uniform MaterialTable
+{
+    Material materials[256];
+};
+
+int cellDensity(uint cell)
+{
+    return materials[cellType(cell)].density;
+}
+
+int cellMovement(uint cell)
+{
+    return materials[cellType(cell)].movement;
+}
+
+vec4 cellColour(uint cell)
+{
+    Material material = materials[cellType(cell)];
+    vec4 colour = material.colour;
+
+    //small per-cell brightness variation so piles don't look flat
+    if ((material.flags & MATERIAL_FLAG_VARIATION) != 0)
+    {
+        colour.rgb *= mix(0.85, 1.0, float(cellSeed(cell)) / 255.0);
+    }
+    return colour;
+}
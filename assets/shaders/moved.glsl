@@ -0,0 +1,33 @@
+//cells that moved this tick, an epoch-stamped bitmap (see stamps.glsl and tiles.glsl, which must be included first)
+layout(std430, binding = 3) buffer movedBuffer
+{
+    uint moved[];
+};
+
+void markTileActive(uint IDx)
+{
+    tileStamp[IDx / uint(TILE_SIZE * TILE_SIZE)] = tick;
+}
+
+void markMoved(uint IDx)
+{
+    markTileActive(IDx);
+
+    uint word = stampWord(IDx);
+    uint expected = moved[word];
+    uint desired;
+    while (stampSet(expected, IDx, desired))
+    {
+        uint result = atomicCompSwap(moved[word], expected, desired);
+        if (result == expected)
+        {
+            return;
+        }
+        expected = result;
+    }
+}
+
+bool hasMoved(uint IDx)
+{
+    return stampIsSet(moved[stampWord(IDx)], IDx);
+}
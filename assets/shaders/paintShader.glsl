@@ -0,0 +1,37 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "stamps.glsl"
+#include "tiles.glsl"
+#include "moved.glsl"
+#include "hash.glsl"
+#include "brush.glsl"
+
+//user painting for the multi-pass and phased modes, only dispatched over the brush's bounding box
+//(starting at paintOrigin) while a mouse button is held
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+uniform ivec2 paintOrigin;
+
+void main()
+{
+    ivec2 gID = paintOrigin + ivec2(gl_GlobalInvocationID.xy);
+    if (!insideGrid(gID))
+    {
+        return;
+    }
+
+    uint IDx = cellIndex(gID);
+    uint currentCell = loadCell(gID);
+    uint paintedCell = applyBrush(currentCell, gID, ivec2(gridWidth, gridHeight), hash(IDx ^ tick));
+
+    if (paintedCell != currentCell)
+    {
+        storeCell(gID, paintedCell);
+        markTileActive(IDx);
+    }
+}
@@ -0,0 +1,99 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "stamps.glsl"
+#include "tiles.glsl"
+#include "moved.glsl"
+#include "hash.glsl"
+
+//parity-phased kernel: each dispatch only runs the cells of one phase (every phaseStride-th cell
+//starting at phaseOffset), chosen so no two invocations can touch the same destination and no
+//destination is itself a source. cells are swapped in place without claims, and all randomness
+//comes from the tick, so a tick's result is fully deterministic
+//  gravity:    stride (1, 2), 2 phases
+//  diagonal:   stride (3, 2), 6 phases
+//  horizontal: stride (3, 1), 3 phases
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+//PASS is defined by main.cpp, one program per pass as in computeShader.glsl
+#ifndef PASS
+#error PASS must be defined
+#endif
+
+uniform ivec2 phaseStride;
+uniform ivec2 phaseOffset;
+
+bool tryMove(ivec2 source, ivec2 destination, uint cell)
+{
+    if (!insideGrid(destination))
+    {
+        return false;
+    }
+
+    uint destCell = loadCell(destination);
+
+    if (cellDensity(destCell) >= cellDensity(cell))
+    {
+        return false;
+    }
+
+    storeCell(destination, cell);
+    storeCell(source, destCell);
+
+    markMoved(cellIndex(source));
+    markMoved(cellIndex(destination));
+    return true;
+}
+
+void main()
+{
+    ivec2 gID = ivec2(gl_GlobalInvocationID.xy) * phaseStride + phaseOffset;
+    if (gID.x >= gridWidth || gID.y >= gridHeight)
+    {
+        return;
+    }
+
+    uint IDx = cellIndex(gID);
+    uint currentCell = loadCell(gID);
+
+    //a cell can only have been marked by an earlier phase: within a phase no destination is a source
+    if (hasMoved(IDx))
+    {
+        return;
+    }
+
+#if PASS == 0
+    //gravity pass
+    else if (cellMovement(currentCell) != MOVEMENT_STATIC)
+    {
+        tryMove(gID, gID + ivec2(0, -1), currentCell);
+    }
+
+#elif PASS == 1
+    //diagonal movement pass
+    else if (cellMovement(currentCell) == MOVEMENT_POWDER)
+    {
+        int side = ((hash(IDx ^ tick) & 1u) == 0u) ? 1 : -1;
+        if (!tryMove(gID, gID + ivec2(side, -1), currentCell))
+        {
+            tryMove(gID, gID + ivec2(-side, -1), currentCell);
+        }
+    }
+
+#elif PASS == 2
+    //horizontal movement pass
+    else if (cellMovement(currentCell) == MOVEMENT_LIQUID)
+    {
+        int inertia = cellInertia(currentCell);
+        int side = inertia != 0 ? inertia : (((hash(IDx + tick * 997u) & 1u) == 0u) ? 1 : -1);
+        if (!tryMove(gID, gID + ivec2(side, 0), currentCell))
+        {
+            tryMove(gID, gID + ivec2(-side, 0), currentCell);
+        }
+    }
+#endif
+}
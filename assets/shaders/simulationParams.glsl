@@ -0,0 +1,15 @@
+//per tick parameters shared by every kernel and the renderer, mirrored in
+//src/simulation/SimulationParams.h and written by the host with a single buffer update per tick
+layout(std140, binding = 1) uniform SimulationParams
+{
+    int gridWidth;
+    int gridHeight;
+    uint tick;
+
+    //user painting, see brush.glsl
+    int mouseX;
+    int mouseY;
+    int brushRadius;
+    bool leftMouseDown;
+    bool rightMouseDown;
+};
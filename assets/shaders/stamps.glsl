@@ -0,0 +1,33 @@
+//claim and moved words hold 16 cells each: the upper 16 bits stamp the epoch (tick) that last wrote
+//the word and the lower 16 bits are one flag per cell. flags from an older epoch read as clear,
+//so the buffers never need a reset pass; the host clears them once whenever the epoch wraps
+const uint STAMP_FLAG_MASK = 0xFFFFu;
+const uint STAMP_EPOCH_SHIFT = 16u;
+
+uint stampWord(uint IDx)
+{
+    return IDx >> 4;
+}
+
+uint stampBit(uint IDx)
+{
+    return 1u << (IDx & 15u);
+}
+
+uint stampEpoch()
+{
+    return tick & STAMP_FLAG_MASK;
+}
+
+bool stampIsSet(uint word, uint IDx)
+{
+    return (word >> STAMP_EPOCH_SHIFT) == stampEpoch() && (word & stampBit(IDx)) != 0u;
+}
+
+//the value a word should hold after setting IDx's flag; returns false if the flag was already set this epoch
+bool stampSet(uint word, uint IDx, out uint result)
+{
+    uint current = (word >> STAMP_EPOCH_SHIFT) == stampEpoch() ? word : stampEpoch() << STAMP_EPOCH_SHIFT;
+    result = current | stampBit(IDx);
+    return (current & stampBit(IDx)) == 0u;
+}
@@ -0,0 +1,17 @@
+//per tile statistics for the debug views, written by tileDebugShader.glsl, mirrored in main.cpp
+const uint TILE_STATE_ACTIVE = 0u;   //simulated and something moved
+const uint TILE_STATE_SLEEPING = 1u; //simulated but settled
+const uint TILE_STATE_SKIPPED = 2u;  //not dispatched at all
+
+struct TileDebug
+{
+    float activity; //fraction of the tile's cells moving, averaged over a decaying window
+    uint state;
+    uint cost;      //invocations per pass that did more than an early out
+    uint padding;
+};
+
+layout(std430, binding = 8) buffer TileDebugBuffer
+{
+    TileDebug tileDebug[];
+};
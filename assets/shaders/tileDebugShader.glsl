@@ -0,0 +1,67 @@
+#version 430 core
+
+#include "grid.glsl"
+#include "gridStorage.glsl"
+#include "cell.glsl"
+#include "materials.glsl"
+#include "stamps.glsl"
+#include "tiles.glsl"
+#include "moved.glsl"
+#include "tileDebug.glsl"
+
+//gathers the per tile statistics shown by the activity and tile debug views, one workgroup per
+//tile, once per tick and only while one of those views is on
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+//weight kept by the activity average each tick, defined by the host
+#ifndef ACTIVITY_DECAY
+#error ACTIVITY_DECAY must be defined
+#endif
+const float activityDecay = ACTIVITY_DECAY;
+
+//true when the simulation only dispatches awake tiles and movable cells (the multi-pass mode's
+//live cell list), otherwise every cell of every tile gets an invocation
+uniform bool tileSkipping;
+
+shared uint movedCells;
+shared uint movableCells;
+
+void main()
+{
+    ivec2 tile = ivec2(gl_WorkGroupID.xy);
+    ivec2 gID = tile * TILE_SIZE + ivec2(gl_LocalInvocationID.xy);
+
+    if (gl_LocalInvocationIndex == 0u)
+    {
+        movedCells = 0u;
+        movableCells = 0u;
+    }
+    barrier();
+
+    if (insideGrid(gID))
+    {
+        uint IDx = cellIndex(gID);
+        if (hasMoved(IDx))
+        {
+            atomicAdd(movedCells, 1u);
+        }
+        if (cellMovement(loadCell(gID)) != MOVEMENT_STATIC)
+        {
+            atomicAdd(movableCells, 1u);
+        }
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0u)
+    {
+        uint index = uint(tile.y * tilesX() + tile.x);
+        bool dispatched = !tileSkipping || tileAwake(tile, tick);
+
+        TileDebug stats = tileDebug[index];
+        stats.activity = stats.activity * activityDecay + (1.0 - activityDecay) * float(movedCells) / float(TILE_SIZE * TILE_SIZE);
+        stats.state = !dispatched ? TILE_STATE_SKIPPED : (movedCells > 0u ? TILE_STATE_ACTIVE : TILE_STATE_SLEEPING);
+        stats.cost = !dispatched ? 0u : (tileSkipping ? movableCells : uint(TILE_SIZE * TILE_SIZE));
+        tileDebug[index] = stats;
+    }
+}
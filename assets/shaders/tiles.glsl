@@ -0,0 +1,22 @@
+//last tick in which anything changed in each 16x16 tile (see grid.glsl, which must be included first)
+layout(std430, binding = 4) buffer TileStampBuffer
+{
+    uint tileStamp[];
+};
+
+//a tile is simulated if it or a neighbour changed in the last two ticks. two rather than one
+//because the host skips a tick when the stamp epoch wraps
+bool tileAwake(ivec2 tile, uint currentTick)
+{
+    for (int y = max(tile.y - 1, 0); y <= min(tile.y + 1, tilesY() - 1); y++)
+    {
+        for (int x = max(tile.x - 1, 0); x <= min(tile.x + 1, tilesX() - 1); x++)
+        {
+            if (tileStamp[y * tilesX() + x] + 2u >= currentTick)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#run as a script (cmake -DSHADER_DIR=... -DOUTPUT=... -P EmbedShaders.cmake), writes OUTPUT: a C++
+#source holding every file in SHADER_DIR as a null terminated byte array, see src/shader/EmbeddedShaders.h
+file(GLOB shaderFiles RELATIVE "${SHADER_DIR}" "${SHADER_DIR}/*")
+list(SORT shaderFiles)
+
+set(arrays "")
+set(table "")
+set(index 0)
+foreach(shaderFile ${shaderFiles})
+    file(READ "${SHADER_DIR}/${shaderFile}" bytes HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${bytes}")
+    string(APPEND arrays "static const unsigned char shader${index}[] = {${bytes}0x00};\n")
+    string(APPEND table "    {\"${shaderFile}\", (const char*)shader${index}, sizeof(shader${index}) - 1},\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT}"
+"//generated from ${SHADER_DIR} by cmake/EmbedShaders.cmake, do not edit
+#include \"shader/EmbeddedShaders.h\"
+
+${arrays}
+const EmbeddedShader embeddedShaders[] = {
+${table}};
+
+const size_t embeddedShaderCount {${index}};
+")
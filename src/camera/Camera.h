@@ -0,0 +1,87 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <algorithm>
+#include <cmath>
+
+//2D camera over the grid: a centre in cells and a zoom in screen pixels per cell. screen
+//coordinates are SDL's, with y pointing down, grid coordinates have y pointing up
+class Camera
+{
+public:
+    float centreX;
+    float centreY;
+    float zoom;
+
+    Camera(int gridWidth, int gridHeight, float zoom, float minZoom, float maxZoom)
+    {
+        this->gridWidth = gridWidth;
+        this->gridHeight = gridHeight;
+        this->minZoom = minZoom;
+        this->maxZoom = maxZoom;
+        this->zoom = std::clamp(zoom, minZoom, maxZoom);
+        centreX = gridWidth * 0.5f;
+        centreY = gridHeight * 0.5f;
+    }
+
+    //grid position of the bottom left corner of the screen
+    float originX(int screenWidth) const
+    {
+        return centreX - screenWidth * 0.5f / zoom;
+    }
+
+    float originY(int screenHeight) const
+    {
+        return centreY - screenHeight * 0.5f / zoom;
+    }
+
+    void screenToGrid(float screenX, float screenY, int screenWidth, int screenHeight, float& gridX, float& gridY) const
+    {
+        gridX = originX(screenWidth) + screenX / zoom;
+        gridY = originY(screenHeight) + (screenHeight - screenY) / zoom;
+    }
+
+    //moves the view by a drag of (dx, dy) screen pixels, so the grid follows the cursor
+    void pan(float dx, float dy)
+    {
+        centreX = std::clamp(centreX - dx / zoom, 0.0f, (float)gridWidth);
+        centreY = std::clamp(centreY + dy / zoom, 0.0f, (float)gridHeight);
+    }
+
+    //zooms by factor while keeping the grid position under the cursor fixed
+    void zoomAt(float screenX, float screenY, int screenWidth, int screenHeight, float factor)
+    {
+        float beforeX, beforeY;
+        screenToGrid(screenX, screenY, screenWidth, screenHeight, beforeX, beforeY);
+
+        zoom = std::clamp(zoom * factor, minZoom, maxZoom);
+
+        float afterX, afterY;
+        screenToGrid(screenX, screenY, screenWidth, screenHeight, afterX, afterY);
+        centreX = std::clamp(centreX + beforeX - afterX, 0.0f, (float)gridWidth);
+        centreY = std::clamp(centreY + beforeY - afterY, 0.0f, (float)gridHeight);
+    }
+
+    //range of tiles of tileSize cells that are at least partly on screen, clamped to the grid
+    void visibleTiles(int screenWidth, int screenHeight, int tileSize, int& firstX, int& firstY, int& countX, int& countY) const
+    {
+        int tilesX = (gridWidth + tileSize - 1) / tileSize;
+        int tilesY = (gridHeight + tileSize - 1) / tileSize;
+
+        firstX = std::clamp((int)std::floor(originX(screenWidth) / tileSize), 0, tilesX);
+        firstY = std::clamp((int)std::floor(originY(screenHeight) / tileSize), 0, tilesY);
+        int lastX = std::clamp((int)std::floor((originX(screenWidth) + screenWidth / zoom) / tileSize), 0, tilesX - 1);
+        int lastY = std::clamp((int)std::floor((originY(screenHeight) + screenHeight / zoom) / tileSize), 0, tilesY - 1);
+
+        countX = std::max(lastX - firstX + 1, 0);
+        countY = std::max(lastY - firstY + 1, 0);
+    }
+
+private:
+    int gridWidth;
+    int gridHeight;
+    float minZoom;
+    float maxZoom;
+};
+
+#endif
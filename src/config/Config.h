@@ -0,0 +1,128 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+//startup settings, all overridable from the command line
+struct Config
+{
+    int windowWidth {1920};
+    int windowHeight {1080};
+    //0 means half the window size, i.e. four screens at 8 pixels per cell
+    int gridWidth {0};
+    int gridHeight {0};
+    //initial screen pixels per cell, 0 fits the whole grid in the window
+    float cellScale {0.0f};
+    double tickRate {120.0};
+    //keep the grid in an r32ui image instead of a shader storage buffer (see gridStorage.glsl)
+    bool gridImage {false};
+    //if set, time this many ticks with each grid storage and exit instead of opening the simulation
+    int benchmarkTicks {0};
+    //where linked shader programs are cached between runs, empty (the default) disables the cache
+    std::string shaderCacheDirectory;
+    //read shader files from this directory instead of the copies built into the executable
+    std::string shaderSourceDirectory;
+};
+
+inline void printUsage(const char* program)
+{
+    std::cout << "usage: " << program << " [options]\n"
+              << "  --grid WxH         grid size in cells (default: half the window size)\n"
+              << "  --window WxH       initial window size in pixels (default: 1920x1080)\n"
+              << "  --scale PIXELS     initial screen pixels per cell (default: fit the grid)\n"
+              << "  --tick-rate HZ     simulation ticks per second (default: 120)\n"
+              << "  --grid-storage S   where the grid lives, buffer or image (default: buffer)\n"
+              << "  --benchmark TICKS  time TICKS ticks with each grid storage, then exit\n"
+              << "  --shader-dir DIR   read shaders from DIR instead of the built in copies\n"
+              << "  --shader-cache DIR cache linked programs in DIR, or off (default: off)\n"
+              << "  --help             show this message" << std::endl;
+}
+
+inline bool parseSize(const std::string& text, int& width, int& height)
+{
+    char separator {0};
+    return std::sscanf(text.c_str(), "%d%c%d", &width, &separator, &height) == 3 && separator == 'x' && width > 0 && height > 0;
+}
+
+//fills in config from argv, returns false (after saying why) if the program shouldn't start
+inline bool parseConfig(int argc, char** argv, Config& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--help")
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "ERROR: missing value for " << option << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+
+        std::string value = argv[++i];
+        bool valid {true};
+        if (option == "--grid")
+        {
+            valid = parseSize(value, config.gridWidth, config.gridHeight);
+        }
+        else if (option == "--window")
+        {
+            valid = parseSize(value, config.windowWidth, config.windowHeight);
+        }
+        else if (option == "--scale")
+        {
+            config.cellScale = std::strtof(value.c_str(), nullptr);
+            valid = config.cellScale > 0.0f;
+        }
+        else if (option == "--tick-rate")
+        {
+            config.tickRate = std::strtod(value.c_str(), nullptr);
+            valid = config.tickRate > 0.0;
+        }
+        else if (option == "--grid-storage")
+        {
+            config.gridImage = value == "image";
+            valid = value == "image" || value == "buffer";
+        }
+        else if (option == "--benchmark")
+        {
+            config.benchmarkTicks = std::atoi(value.c_str());
+            valid = config.benchmarkTicks > 0;
+        }
+        else if (option == "--shader-dir")
+        {
+            config.shaderSourceDirectory = value;
+        }
+        else if (option == "--shader-cache")
+        {
+            config.shaderCacheDirectory = value == "off" ? "" : value;
+        }
+        else
+        {
+            std::cerr << "ERROR: unknown option " << option << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "ERROR: invalid value for " << option << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    if (config.gridWidth == 0)
+    {
+        config.gridWidth = config.windowWidth / 2;
+        config.gridHeight = config.windowHeight / 2;
+    }
+    return true;
+}
+
+#endif
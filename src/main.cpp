@@ -1,27 +1,133 @@
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
 #include <SDL3/SDL.h>
 #include <glad.h>
 #include "shader/Shader.h"
+#include "shader/ShaderWatcher.h"
+#include "material/Material.h"
+#include "simulation/SimulationClock.h"
+#include "simulation/SimulationParams.h"
+#include "camera/Camera.h"
+#include "config/Config.h"
+#include "profiling/GpuTimers.h"
 
-int constexpr SCR_WIDTH {1920};
-int constexpr SCR_HEIGHT {1080};
-int constexpr GRID_WIDTH {SCR_WIDTH / 8};
-int constexpr GRID_HEIGHT {SCR_HEIGHT / 8};
+//window and grid sizes come from the command line, see config/Config.h
+float constexpr MIN_ZOOM {1.0f / 16.0f};
+float constexpr MAX_ZOOM {32.0f};
+float constexpr ZOOM_STEP {1.25f};
 
-struct Cell
+//levels of the colour image's mip pyramid, the last one has a texel per 16x16 tile
+int constexpr COLOUR_LEVELS {5};
+int constexpr BRUSH_RADIUS {4};
+
+//the most simulation ticks run in one frame before the simulation is allowed to fall behind real time
+int constexpr MAX_TICKS_PER_FRAME {8};
+
+//packed cell, mirrored in the shaders:
+//bits 0-7 material id, bits 9-10 inertia sign, bits 16-23 colour variation seed
+typedef uint32_t Cell;
+
+//the grid is stored as whole 16x16 tiles, Morton ordered within each tile (see cellIndex in
+//grid.glsl), so every per-cell buffer is sized for the tiles rather than the grid
+int constexpr TILE_CELLS {16 * 16};
+
+//image unit of the grid when it is stored as an image, mirrored in gridStorage.glsl
+int constexpr GRID_IMAGE_UNIT {2};
+
+enum SimulationMode
+{
+    SIMULATION_PASSES,   //one dispatch per pass over the live cells, claims resolved in global memory
+    SIMULATION_FUSED,    //one dispatch per tick, each workgroup simulates its tile in shared memory
+    SIMULATION_MARGOLUS, //one dispatch per tick, each invocation owns a 2x2 block, no atomics
+    SIMULATION_PHASED,   //one dispatch per parity phase, in place and deterministic, no claims
+    SIMULATION_MODE_COUNT
+};
+
+const char* const simulationModeNames[SIMULATION_MODE_COUNT] = {"multi-pass", "fused", "margolus", "phased"};
+
+//movement passes of the multi-pass and phased modes: 0 gravity, 1 diagonal, 2 horizontal. each gets
+//its own program, with the pass compiled in as PASS (see computeShader.glsl)
+int constexpr SIMULATION_PASSES_PER_TICK {3};
+
+//mirrored in fragmentShader.frag
+enum DebugView
+{
+    DEBUG_NONE,
+    DEBUG_MOVED,    //cells that moved in the last tick
+    DEBUG_ACTIVITY, //decaying per tile heatmap of moving cells
+    DEBUG_TILES,    //per tile state (active, sleeping, skipped) and workgroup cost
+    DEBUG_VIEW_COUNT
+};
+
+const char* const debugViewNames[DEBUG_VIEW_COUNT] = {"none", "moved cells", "activity", "tiles"};
+
+//per tile record written by tileDebugShader.glsl, see tileDebug.glsl
+struct TileDebug
+{
+    float activity;
+    uint32_t state;
+    uint32_t cost;
+    uint32_t padding;
+};
+
+//parts of the frame timed on the GPU while the timers are on (T), see profiling/GpuTimers.h. the
+//movement passes are shared by the multi-pass and phased modes, indexed TIMER_GRAVITY + pass
+enum TimerSection
+{
+    TIMER_PAINT,
+    TIMER_TILE_LISTS, //active tile and live cell lists
+    TIMER_GRAVITY,
+    TIMER_DIAGONAL,
+    TIMER_HORIZONTAL,
+    TIMER_FUSED,
+    TIMER_MARGOLUS,
+    TIMER_TILE_DEBUG,
+    TIMER_COLOUR,     //colour image and its pyramid
+    TIMER_RENDER,
+    TIMER_SECTION_COUNT
+};
+
+const char* const timerSectionNames[TIMER_SECTION_COUNT] = {"paint", "tile lists", "gravity", "diagonal", "horizontal", "fused", "margolus", "tile debug", "colour", "render"};
+
+//frames the timer statistics cover, and how often they are printed while the timers are on
+int constexpr GPU_TIMER_WINDOW {240};
+Uint64 constexpr GPU_TIMER_PRINT_MS {1000};
+
+//weight the activity heatmap keeps each tick, about a quarter of a second half-life at 120 ticks
+float constexpr ACTIVITY_DECAY {0.977f};
+
+//one dispatch of the phased kernel: runs pass on every stride-th cell starting at offset
+struct SimulationPhase
 {
-    float colour[4];
-    int type;
-    int justMoved;
-    int density;
-    int inertia;
+    int pass;
+    int strideX, strideY;
+    int offsetX, offsetY;
 };
 
-void updateGridBuffers(GLuint& gridBuffer, GLuint& nextGridBuffer);
+std::vector<SimulationPhase> buildPhasedSchedule();
+
+void paintBrush(Shader& paintCompute, const Config& config, int mouseX, int mouseY);
+std::vector<Shader> buildPassPrograms(const char* computeName, const std::vector<std::string>& defines);
+bool checkGridLimits(const Config& config);
+uint32_t gridCellIndex(int x, int y, int tilesX);
+GLuint createGridTexture(const Config& config, const std::vector<Cell>& cells);
+void runStorageBenchmark(const Config& config);
+void clearStampBuffers(GLuint claimBuffer, GLuint movedBuffer);
+void updateIdleState(GLsync& dirtyFence, GLuint dirtyTileBuffer, GLuint dirtyReadbackBuffer, bool ranTicks, bool& sceneIdle);
 void checkOpenGLError();
 
 int main(int argc, char **argv)
 {
+    Config config;
+    if (!parseConfig(argc, argv, config))
+    {
+        return -1;
+    }
+
     //initialise SDL3
     if (!SDL_Init(SDL_INIT_VIDEO))
     {
@@ -38,7 +144,7 @@ int main(int argc, char **argv)
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
     //create window
-    SDL_Window* window = SDL_CreateWindow("falling sand experiment", SCR_WIDTH, SCR_HEIGHT, SDL_WINDOW_OPENGL);
+    SDL_Window* window = SDL_CreateWindow("falling sand experiment", config.windowWidth, config.windowHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
 
     if (!window)
     {
@@ -76,6 +182,31 @@ int main(int argc, char **argv)
         std::cout << "GLAD successfully initialised" << std::endl;
     }
 
+    if (!checkGridLimits(config))
+    {
+        SDL_GL_DestroyContext(glContext);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return -1;
+    }
+    std::cout << "Grid: " << config.gridWidth << "x" << config.gridHeight << " cells" << std::endl;
+
+    Shader::sourceDirectory = config.shaderSourceDirectory;
+    Shader::binaryCacheDirectory = config.shaderCacheDirectory;
+
+    if (config.benchmarkTicks > 0)
+    {
+        runStorageBenchmark(config);
+        SDL_GL_DestroyContext(glContext);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 0;
+    }
+
+    //drawable size in pixels, which differs from the window size on high density displays
+    int screenWidth, screenHeight;
+    SDL_GetWindowSizeInPixels(window, &screenWidth, &screenHeight);
+
     //face data
     float vertices[] = {
         // vertex positions
@@ -108,73 +239,177 @@ int main(int argc, char **argv)
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    //create shader program
-    Shader automataShader("../assets/shaders/vertexShader.vert", "../assets/shaders/fragmentShader.frag");
-    Shader automataCompute("../assets/shaders/computeShader.glsl");
+    //create shader program, the kernels that touch the grid are built for its storage
+    std::vector<std::string> gridDefines;
+    if (config.gridImage)
+    {
+        gridDefines.push_back("GRID_IMAGE");
+    }
+
+    Shader automataShader("vertexShader.vert", "fragmentShader.frag");
+    std::vector<Shader> automataPasses = buildPassPrograms("computeShader.glsl", gridDefines);
+    Shader fusedCompute("fusedComputeShader.glsl", gridDefines);
+    Shader margolusCompute("margolusComputeShader.glsl", gridDefines);
+    std::vector<Shader> phasedPasses = buildPassPrograms("phasedComputeShader.glsl", gridDefines);
+    Shader activeTilesCompute("activeTilesShader.glsl");
+    Shader liveCellsCompute("liveCellsShader.glsl", gridDefines);
+    Shader paintCompute("paintShader.glsl", gridDefines);
+    Shader colourCompute("colourShader.glsl", gridDefines);
+    Shader downsampleCompute("downsampleShader.glsl");
+    std::vector<std::string> tileDebugDefines = gridDefines;
+    tileDebugDefines.push_back("ACTIVITY_DECAY " + std::to_string(ACTIVITY_DECAY));
+    Shader tileDebugCompute("tileDebugShader.glsl", tileDebugDefines);
+
+    //with --shader-dir, saving a shader file rebuilds the programs whose expanded sources changed
+    //between frames, the rest are left alone, as are all buffers and textures
+    ShaderWatcher shaderWatcher(config.shaderSourceDirectory);
+    std::vector<Shader*> allShaders {&automataShader, &fusedCompute, &margolusCompute, &activeTilesCompute, &liveCellsCompute, &paintCompute, &colourCompute, &downsampleCompute, &tileDebugCompute};
+    for (Shader& pass : automataPasses)
+    {
+        allShaders.push_back(&pass);
+    }
+    for (Shader& pass : phasedPasses)
+    {
+        allShaders.push_back(&pass);
+    }
+
+    GLuint materialBuffer = createMaterialBuffer();
+    GLuint paramsBuffer = createSimulationParamsBuffer();
 
-    GLuint gridBuffer, nextGridBuffer, claimBuffer, movedBuffer;
-    glGenBuffers(1, &gridBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, GRID_WIDTH * GRID_HEIGHT * sizeof(Cell), nullptr, GL_DYNAMIC_DRAW);
+    int numWorkGroupsX = (config.gridWidth + 15) / 16;
+    int numWorkGroupsY = (config.gridHeight + 15) / 16;
 
-    Cell* data = (Cell*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, GRID_WIDTH * GRID_HEIGHT * sizeof(Cell), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    //one 16x16 tile per workgroup, the grid padded out to whole tiles
+    int numTiles {numWorkGroupsX * numWorkGroupsY};
+    int gridCells {numTiles * TILE_CELLS};
+
+    //every simulation mode updates the grid in place, so there is a single grid, either a buffer in
+    //cellIndex order or an image at grid resolution (see gridStorage.glsl), starting out as air
+    GLuint gridBuffer {0}, gridTexture {0};
+    if (config.gridImage)
+    {
+        gridTexture = createGridTexture(config, std::vector<Cell>(config.gridWidth * config.gridHeight, 0));
+    }
+    else
+    {
+        glGenBuffers(1, &gridBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, gridCells * sizeof(Cell), nullptr, GL_DYNAMIC_DRAW);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
 
-    glGenBuffers(1, &nextGridBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, nextGridBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, GRID_WIDTH * GRID_HEIGHT * sizeof(Cell), nullptr, GL_DYNAMIC_DRAW);
+    //claim and moved are epoch-stamped bitmaps, 16 cells per word (see stamps.glsl)
+    int bitmapWords {gridCells / 16};
 
+    GLuint claimBuffer, movedBuffer;
     glGenBuffers(1, &claimBuffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, claimBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, GRID_WIDTH * GRID_HEIGHT * sizeof(int), nullptr, GL_DYNAMIC_DRAW);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, bitmapWords * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
 
     glGenBuffers(1, &movedBuffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, movedBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, GRID_WIDTH * GRID_HEIGHT * sizeof(int), nullptr, GL_DYNAMIC_DRAW);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, bitmapWords * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
 
-    for (int i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++)
-    {
-        data[i].type = 0;
-        data[i].colour[0] = 0.0f;
-        data[i].colour[1] = 0.0f;
-        data[i].colour[2] = 0.0f;
-        data[i].colour[3] = 0.0f;
-        data[i].justMoved = 0;
-        data[i].density = 0;
-        data[i].inertia = 0;
-    }
+    clearStampBuffers(claimBuffer, movedBuffer);
+
+    //the last tick each tile changed, and the GPU-built list of tiles to run this tick, prefixed by
+    //its indirect dispatch size (see activeTilesShader.glsl)
+    GLuint tileStampBuffer, activeTileBuffer;
+    glGenBuffers(1, &tileStampBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileStampBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, numTiles * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    glGenBuffers(1, &activeTileBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, activeTileBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (3 + numTiles) * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+    //compact list of the movable cells in the active tiles, prefixed by its indirect dispatch size
+    //and its length (see liveCellsShader.glsl)
+    GLuint liveCellBuffer;
+    glGenBuffers(1, &liveCellBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, liveCellBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (4 + gridCells) * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+    //cell colours plus a pyramid for zooming out, only rewritten for tiles that changed (see
+    //colourShader.glsl and downsampleShader.glsl). the image covers whole tiles, so every level is
+    //exactly half the one below and a cell's texel at any level is its position shifted by the level
+    GLuint colourTexture;
+    glGenTextures(1, &colourTexture);
+    glBindTexture(GL_TEXTURE_2D, colourTexture);
+    glTexStorage2D(GL_TEXTURE_2D, COLOUR_LEVELS, GL_RGBA8, numWorkGroupsX * 16, numWorkGroupsY * 16);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    GLuint tileDebugBuffer;
+    glGenBuffers(1, &tileDebugBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileDebugBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, numTiles * sizeof(TileDebug), nullptr, GL_DYNAMIC_DRAW);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gridBuffer);
+    //number of tiles recoloured, copied to a readback buffer and read once its fence has signalled
+    //so the CPU never waits on the GPU (see colourShader.glsl)
+    GLuint dirtyTileBuffer, dirtyReadbackBuffer;
+    glGenBuffers(1, &dirtyTileBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, dirtyTileBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
 
-    int numWorkGroupsX = (GRID_WIDTH + 15) / 16;
-    int numWorkGroupsY = (GRID_HEIGHT + 15) / 16;
+    glGenBuffers(1, &dirtyReadbackBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, dirtyReadbackBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(uint32_t), nullptr, GL_STREAM_READ);
+
+    //margolus blocks are 2x2 and offset by one cell on alternate ticks, so one extra block per axis
+    int numBlockGroupsX = (config.gridWidth / 2 + 1 + 15) / 16;
+    int numBlockGroupsY = (config.gridHeight / 2 + 1 + 15) / 16;
+
+    std::vector<SimulationPhase> phasedSchedule = buildPhasedSchedule();
 
     //main loop
     std::cout << "Starting main loop" << std::endl;
 
     SDL_Event e;
 
-    const int targetFPS {1000};
-    const float frameDelay {1000 / targetFPS};
+    //rendering follows the display, the simulation follows the clock
+    SDL_GL_SetSwapInterval(1);
+    SimulationClock simulationClock(config.tickRate, MAX_TICKS_PER_FRAME);
+
+    //starts at the configured scale, or zoomed out to the whole grid
+    float fitZoom = std::min((float)screenWidth / config.gridWidth, (float)screenHeight / config.gridHeight);
+    Camera camera(config.gridWidth, config.gridHeight, config.cellScale > 0.0f ? config.cellScale : fitZoom, MIN_ZOOM, MAX_ZOOM);
+    bool cameraMoved {false};
+
+    uint32_t tick {0};
+    bool showMoved {false};
+    DebugView debugView {DEBUG_NONE};
+    SimulationMode simulationMode {SIMULATION_PASSES};
+    bool liveCellsOnly {true};
+    uint32_t colourSince {0};
+    GLsync dirtyFence {nullptr};
+    bool sceneIdle {false};
+    bool forcePresent {true};
 
-    int numPasses {5};
-    bool debugView {false};
+    GpuTimers gpuTimers(std::vector<std::string>(timerSectionNames, timerSectionNames + TIMER_SECTION_COUNT), GPU_TIMER_WINDOW);
+    Uint64 lastTimerPrint {0};
 
     bool running {true};
     while (running)
     {
-        Uint32 frameStart = SDL_GetTicks();
-
         //mouse position and held state
         float mouseX, mouseY;
         uint32_t mouseState = SDL_GetMouseState(&mouseX, &mouseY);
 
-        float mouseXNormal {mouseX / (float)SCR_WIDTH * GRID_WIDTH};
-        float mouseYNormal {GRID_HEIGHT - (mouseY / (float)SCR_HEIGHT * GRID_HEIGHT)};
+        //SDL reports the mouse in window coordinates, the camera works in pixels
+        float pixelDensity = SDL_GetWindowPixelDensity(window);
+        float mouseXNormal, mouseYNormal;
+        camera.screenToGrid(mouseX * pixelDensity, mouseY * pixelDensity, screenWidth, screenHeight, mouseXNormal, mouseYNormal);
 
-        bool leftMouseDown = (mouseState & SDL_BUTTON_MASK(SDL_BUTTON_LEFT)) != 0;
-        bool rightMouseDown = (mouseState & SDL_BUTTON_MASK(SDL_BUTTON_RIGHT)) != 0;
+        //only paint while the cursor is over the grid, the brush would otherwise clamp to its edge
+        bool mouseInGrid = mouseXNormal >= 0.0f && mouseYNormal >= 0.0f && mouseXNormal < config.gridWidth && mouseYNormal < config.gridHeight;
+        bool leftMouseDown = mouseInGrid && (mouseState & SDL_BUTTON_MASK(SDL_BUTTON_LEFT)) != 0;
+        bool rightMouseDown = mouseInGrid && (mouseState & SDL_BUTTON_MASK(SDL_BUTTON_RIGHT)) != 0;
 
         //SDL events - keyboard inputs etc...
         while(SDL_PollEvent(&e))
@@ -183,83 +418,359 @@ int main(int argc, char **argv)
             {
                 running = false;
             }
+            else if (e.type == SDL_EVENT_WINDOW_EXPOSED)
+            {
+                forcePresent = true;
+            }
+            //only the viewport and the camera's visible area change, the simulation keeps running as is
+            else if (e.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)
+            {
+                screenWidth = e.window.data1;
+                screenHeight = e.window.data2;
+                glViewport(0, 0, screenWidth, screenHeight);
+                cameraMoved = true;
+            }
+            //middle mouse drag pans, the wheel zooms around the cursor
+            else if (e.type == SDL_EVENT_MOUSE_MOTION && (e.motion.state & SDL_BUTTON_MASK(SDL_BUTTON_MIDDLE)))
+            {
+                camera.pan(e.motion.xrel * pixelDensity, e.motion.yrel * pixelDensity);
+                cameraMoved = true;
+            }
+            else if (e.type == SDL_EVENT_MOUSE_WHEEL)
+            {
+                camera.zoomAt(e.wheel.mouse_x * pixelDensity, e.wheel.mouse_y * pixelDensity, screenWidth, screenHeight, std::pow(ZOOM_STEP, e.wheel.y));
+                cameraMoved = true;
+            }
             else if (e.type == SDL_EVENT_KEY_DOWN)
             {
                 if (e.key.key == SDLK_SPACE)
                 {
-                    debugView = true;
+                    showMoved = true;
+                }
+                else if (e.key.key == SDLK_D)
+                {
+                    debugView = (DebugView)((debugView + 1) % DEBUG_VIEW_COUNT);
+                    std::cout << "Debug view: " << debugViewNames[debugView] << std::endl;
+                    forcePresent = true;
+                }
+                else if (e.key.key == SDLK_M)
+                {
+                    simulationMode = (SimulationMode)((simulationMode + 1) % SIMULATION_MODE_COUNT);
+                    std::cout << "Simulation mode: " << simulationModeNames[simulationMode] << std::endl;
+                    forcePresent = true;
+                }
+                else if (e.key.key == SDLK_T)
+                {
+                    gpuTimers.setEnabled(!gpuTimers.isEnabled());
+                    std::cout << "GPU timers: " << (gpuTimers.isEnabled() ? "on" : "off") << std::endl;
+                }
+                else if (e.key.key == SDLK_C)
+                {
+                    liveCellsOnly = !liveCellsOnly;
+                    std::cout << "Live cells only: " << (liveCellsOnly ? "on" : "off") << std::endl;
                 }
             }
             else if (e.type == SDL_EVENT_KEY_UP)
             {
                 if (e.key.key == SDLK_SPACE)
                 {
-                    debugView = false;
+                    showMoved = false;
+                    forcePresent = true;
                 }
             }
         }
 
-        automataCompute.use();
-        automataCompute.setFloat("time", SDL_GetTicks());
-        automataCompute.setInt("gridWidth", GRID_WIDTH);
-        automataCompute.setInt("gridHeight", GRID_HEIGHT);
-        automataCompute.setInt("mouseX", (int)mouseXNormal);
-        automataCompute.setInt("mouseY", (int)mouseYNormal);
-        automataCompute.setBool("leftMouseDown", leftMouseDown);
-        automataCompute.setBool("rightMouseDown", rightMouseDown);
-
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gridBuffer);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, nextGridBuffer);
+        if (shaderWatcher.poll())
+        {
+            int rebuilt {0}, kept {0};
+            for (Shader* shader : allShaders)
+            {
+                Shader::ReloadResult result = shader->reload();
+                rebuilt += result == Shader::RELOAD_REBUILT;
+                kept += result == Shader::RELOAD_FAILED;
+            }
+            std::cout << "Shaders reloaded, " << rebuilt << " programs rebuilt";
+            if (kept > 0)
+            {
+                std::cout << ", " << kept << " failed and kept their previous version";
+            }
+            std::cout << std::endl;
+
+            //the colour kernel may have changed, so recolour everything
+            if (rebuilt > 0)
+            {
+                colourSince = 0;
+                forcePresent = true;
+            }
+        }
+
+        if (config.gridImage)
+        {
+            glBindImageTexture(GRID_IMAGE_UNIT, gridTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+        }
+        else
+        {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gridBuffer);
+        }
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, claimBuffer);
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, movedBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, tileStampBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, activeTileBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, liveCellBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, dirtyTileBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, tileDebugBuffer);
+
+        gpuTimers.beginFrame();
+
+        //everything but the tick is the same for all of this frame's ticks
+        SimulationParams simulationParams {config.gridWidth, config.gridHeight, tick, (int)mouseXNormal, (int)mouseYNormal, BRUSH_RADIUS, leftMouseDown, rightMouseDown};
+
+        //run every tick that is due, all of them recorded before anything waits on the GPU
+        int ticksDue = simulationClock.advance();
+        for (int t = 0; t < ticksDue; t++)
+        {
+            //claim/moved stamps only keep the low 16 bits of the tick, so skip epoch 0 and
+            //clear the stamps on wrap so old flags can never look current
+            tick++;
+            if ((tick & 0xFFFF) == 0)
+            {
+                clearStampBuffers(claimBuffer, movedBuffer);
+                tick++;
+            }
+            simulationParams.tick = tick;
+            updateSimulationParams(paramsBuffer, simulationParams);
+
+            //the fused and margolus kernels paint as they load cells, the others get a dispatch over just the brush
+            bool separatePaint = simulationMode == SIMULATION_PASSES || simulationMode == SIMULATION_PHASED;
+            if (separatePaint && (leftMouseDown || rightMouseDown))
+            {
+                gpuTimers.begin(TIMER_PAINT);
+                paintCompute.use();
+                paintBrush(paintCompute, config, (int)mouseXNormal, (int)mouseYNormal);
+                gpuTimers.end(TIMER_PAINT);
+            }
+
+            if (simulationMode == SIMULATION_FUSED)
+            {
+                //tiles shift by half a tile every other tick, so one extra workgroup per axis covers the edge
+                gpuTimers.begin(TIMER_FUSED);
+                fusedCompute.use();
+                fusedCompute.setInt("tileOffset", (tick & 1) ? 8 : 0);
+                fusedCompute.dispatch(numWorkGroupsX + 1, numWorkGroupsY + 1, 1);
+                gpuTimers.end(TIMER_FUSED);
+            }
+            else if (simulationMode == SIMULATION_MARGOLUS)
+            {
+                gpuTimers.begin(TIMER_MARGOLUS);
+                margolusCompute.use();
+                margolusCompute.setInt("blockOffset", tick & 1);
+                margolusCompute.dispatch(numBlockGroupsX, numBlockGroupsY, 1);
+                gpuTimers.end(TIMER_MARGOLUS);
+            }
+            else if (simulationMode == SIMULATION_PHASED)
+            {
+                for (const SimulationPhase& phase : phasedSchedule)
+                {
+                    int cellsX = (config.gridWidth - phase.offsetX + phase.strideX - 1) / phase.strideX;
+                    int cellsY = (config.gridHeight - phase.offsetY + phase.strideY - 1) / phase.strideY;
+
+                    gpuTimers.begin(TIMER_GRAVITY + phase.pass);
+                    Shader& phasedCompute = phasedPasses[phase.pass];
+                    phasedCompute.use();
+                    phasedCompute.setIVec2("phaseStride", phase.strideX, phase.strideY);
+                    phasedCompute.setIVec2("phaseOffset", phase.offsetX, phase.offsetY);
+                    phasedCompute.dispatch((cellsX + 15) / 16, (cellsY + 15) / 16, 1);
+                    gpuTimers.end(TIMER_GRAVITY + phase.pass);
+                }
+            }
+            else
+            {
+                if (liveCellsOnly)
+                {
+                    gpuTimers.begin(TIMER_TILE_LISTS);
+
+                    //reset the workgroup counts, then let the GPU list the tiles that need to run this tick.
+                    //the previous tick's shaders wrote these headers, so the updates wait for those writes
+                    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+                    GLuint emptyDispatch[3] {0, 1, 1};
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, activeTileBuffer);
+                    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(emptyDispatch), emptyDispatch);
+
+                    GLuint emptyList[4] {0, 1, 1, 0};
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, liveCellBuffer);
+                    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(emptyList), emptyList);
+
+                    activeTilesCompute.use();
+                    activeTilesCompute.dispatch((numWorkGroupsX + 7) / 8, (numWorkGroupsY + 7) / 8, 1);
+                    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+                    //then compact the movable cells of those tiles, one workgroup per tile
+                    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, activeTileBuffer);
+                    liveCellsCompute.use();
+                    liveCellsCompute.dispatchIndirect(0);
+                    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+                    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, liveCellBuffer);
+                    gpuTimers.end(TIMER_TILE_LISTS);
+                }
+
+                /*
+                passes:
+                    0 - gravity
+                    1 - diagonal movement (sand)
+                    2 - horizontal movement (water)
+                */
+                for (int pass = 0; pass < SIMULATION_PASSES_PER_TICK; pass++)
+                {
+                    gpuTimers.begin(TIMER_GRAVITY + pass);
+                    Shader& automataCompute = automataPasses[pass];
+                    automataCompute.use();
+                    automataCompute.setBool("liveCellsOnly", liveCellsOnly);
+                    if (liveCellsOnly)
+                    {
+                        automataCompute.dispatchIndirect(0);
+                    }
+                    else
+                    {
+                        automataCompute.dispatch(numWorkGroupsX, numWorkGroupsY, 1);
+                    }
+                    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                    gpuTimers.end(TIMER_GRAVITY + pass);
+                }
+            }
+
+            //statistics for the activity and tile views, gathered every tick so the heatmap decays in ticks
+            if (debugView == DEBUG_ACTIVITY || debugView == DEBUG_TILES)
+            {
+                gpuTimers.begin(TIMER_TILE_DEBUG);
+                tileDebugCompute.use();
+                tileDebugCompute.setBool("tileSkipping", simulationMode == SIMULATION_PASSES && liveCellsOnly);
+                tileDebugCompute.dispatch(numWorkGroupsX, numWorkGroupsY, 1);
+                gpuTimers.end(TIMER_TILE_DEBUG);
+            }
+        }
+
+        //sceneIdle is a frame or more behind, so a paint stroke into a settled scene is presented
+        //straight away rather than once the readback notices it
+        if (ticksDue > 0 && (leftMouseDown || rightMouseDown))
+        {
+            forcePresent = true;
+        }
+
+        //colouring and drawing still need the grid size and tick when no tick ran this frame
+        if (ticksDue == 0)
+        {
+            updateSimulationParams(paramsBuffer, simulationParams);
+        }
+
+        //tiles off screen aren't recoloured, so everything that comes into view has to be
+        if (cameraMoved)
+        {
+            colourSince = 0;
+            forcePresent = true;
+            cameraMoved = false;
+        }
 
-        /*
-        passes:
-            0 - reset claimBuffer
-            1 - user painting
-            2 - gravity
-            3 - diagonal movement (sand)
-            4 - horizontal movement (water)
-        */
-        for (int i = 0; i < numPasses; i++)
+        //colour the visible tiles that changed since the last frame
+        int firstTileX, firstTileY, visibleTilesX, visibleTilesY;
+        camera.visibleTiles(screenWidth, screenHeight, 16, firstTileX, firstTileY, visibleTilesX, visibleTilesY);
+
+        gpuTimers.begin(TIMER_COLOUR);
+        colourCompute.use();
+        colourCompute.setUint("colourSince", colourSince);
+        colourCompute.setIVec2("firstTile", firstTileX, firstTileY);
+        Shader::bindImage2D(0, colourTexture, GL_WRITE_ONLY);
+        if (visibleTilesX > 0 && visibleTilesY > 0)
         {
-            automataCompute.setInt("pass", i);
-            automataCompute.dispatch(numWorkGroupsX, numWorkGroupsY, 1);
-            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            colourCompute.dispatch(visibleTilesX, visibleTilesY, 1);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+            //then the pyramid, a level at a time, for the same tiles
+            downsampleCompute.use();
+            downsampleCompute.setUint("colourSince", colourSince);
+            downsampleCompute.setIVec2("firstTile", firstTileX, firstTileY);
+            for (int level = 1; level < COLOUR_LEVELS; level++)
+            {
+                downsampleCompute.setInt("level", level);
+                Shader::bindImage2D(0, colourTexture, GL_READ_ONLY, level - 1);
+                Shader::bindImage2D(1, colourTexture, GL_WRITE_ONLY, level);
+                downsampleCompute.dispatch(visibleTilesX, visibleTilesY, 1);
+                glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+            }
         }
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        gpuTimers.end(TIMER_COLOUR);
+        colourSince = tick + 1;
+
+        updateIdleState(dirtyFence, dirtyTileBuffer, dirtyReadbackBuffer, ticksDue > 0, sceneIdle);
+
+        //nothing was recoloured, the last presented frame is still correct
+        DebugView shownView = showMoved ? DEBUG_MOVED : debugView;
+        bool present = !sceneIdle || shownView != DEBUG_NONE || forcePresent;
+        if (present)
+        {
+            forcePresent = false;
+
+            //graphics
+            gpuTimers.begin(TIMER_RENDER);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glClearColor(0.3f, 0.4f, 0.5f, 1.0f); //debug colour in case quad doesn't render
 
-        updateGridBuffers(gridBuffer, nextGridBuffer);
+            automataShader.use();
 
-        //graphics
-        glClear(GL_COLOR_BUFFER_BIT);
-        glClearColor(0.3f, 0.4f, 0.5f, 1.0f); //debug colour in case quad doesn't render
+            automataShader.setVec2("cameraOrigin", camera.originX(screenWidth), camera.originY(screenHeight));
+            automataShader.setFloat("cameraZoom", camera.zoom);
 
-        automataShader.use();
+            //the pyramid level with about one texel per pixel, so zooming out doesn't alias
+            int colourLevel = std::clamp((int)std::floor(std::log2(1.0f / camera.zoom)), 0, COLOUR_LEVELS - 1);
+            automataShader.setInt("colourLevel", colourLevel);
+            automataShader.setInt("debugView", shownView);
 
-        automataShader.setInt("gridWidth", GRID_WIDTH);
-        automataShader.setInt("gridHeight", GRID_HEIGHT);
-        automataShader.setInt("screenWidth", SCR_WIDTH);
-        automataShader.setInt("screenHeight", SCR_HEIGHT);
-        automataShader.setBool("debug", debugView);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, colourTexture);
 
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            gpuTimers.end(TIMER_RENDER);
 
-        SDL_GL_SwapWindow(window);
+            SDL_GL_SwapWindow(window);
+        }
+        else
+        {
+            //the swap waits for the display, an idle frame waits for the next tick instead
+            SDL_DelayNS(simulationClock.nanosecondsUntilNextTick());
+        }
 
-        //framerate delay
-        Uint32 frameTime = SDL_GetTicks() - frameStart;
-        //std::cout << frameTime << std::endl;
-        if (frameDelay > frameTime)
+        gpuTimers.endFrame();
+        if (gpuTimers.isEnabled() && SDL_GetTicks() - lastTimerPrint >= GPU_TIMER_PRINT_MS)
         {
-            SDL_Delay(frameDelay - frameTime);
+            gpuTimers.print();
+            lastTimerPrint = SDL_GetTicks();
         }
     }
 
     std::cout << "Ended main loop" << std::endl;
 
+    glDeleteBuffers(1, &gridBuffer);
+    glDeleteTextures(1, &gridTexture);
+    glDeleteBuffers(1, &claimBuffer);
+    glDeleteBuffers(1, &movedBuffer);
+    glDeleteBuffers(1, &tileStampBuffer);
+    glDeleteBuffers(1, &activeTileBuffer);
+    glDeleteBuffers(1, &liveCellBuffer);
+    glDeleteBuffers(1, &materialBuffer);
+    glDeleteBuffers(1, &paramsBuffer);
+    glDeleteTextures(1, &colourTexture);
+    glDeleteBuffers(1, &dirtyTileBuffer);
+    glDeleteBuffers(1, &tileDebugBuffer);
+    glDeleteBuffers(1, &dirtyReadbackBuffer);
+    if (dirtyFence)
+    {
+        glDeleteSync(dirtyFence);
+    }
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
     glDeleteVertexArrays(1, &VAO);
+    gpuTimers.release();
 
     SDL_GL_DestroyContext(glContext);
 
@@ -272,14 +783,281 @@ int main(int argc, char **argv)
     return 0;
 }
 
-void updateGridBuffers(GLuint& gridBuffer, GLuint& nextGridBuffer)
+std::vector<SimulationPhase> buildPhasedSchedule()
+{
+    std::vector<SimulationPhase> schedule;
+
+    //gravity: alternate rows, so a destination row is never a source row
+    for (int y = 0; y < 2; y++)
+    {
+        schedule.push_back({0, 1, 2, 0, y});
+    }
+
+    //diagonal: alternate rows and every third column, so the two possible destinations of neighbouring sources never overlap
+    for (int y = 0; y < 2; y++)
+    {
+        for (int x = 0; x < 3; x++)
+        {
+            schedule.push_back({1, 3, 2, x, y});
+        }
+    }
+
+    //horizontal: every third column
+    for (int x = 0; x < 3; x++)
+    {
+        schedule.push_back({2, 3, 1, x, 0});
+    }
+
+    return schedule;
+}
+
+//one program per movement pass from the same source, each with its pass defined as PASS
+std::vector<Shader> buildPassPrograms(const char* computeName, const std::vector<std::string>& defines)
+{
+    std::vector<Shader> programs;
+    for (int pass = 0; pass < SIMULATION_PASSES_PER_TICK; pass++)
+    {
+        std::vector<std::string> passDefines = defines;
+        passDefines.push_back("PASS " + std::to_string(pass));
+        programs.emplace_back(computeName, passDefines);
+    }
+    return programs;
+}
+
+//dispatches the paint kernel over the brush's bounding box only
+void paintBrush(Shader& paintCompute, const Config& config, int mouseX, int mouseY)
+{
+    int brushSize {2 * BRUSH_RADIUS + 1};
+    int centreX = std::clamp(mouseX, 0, config.gridWidth - 1);
+    int centreY = std::clamp(mouseY, 0, config.gridHeight - 1);
+
+    paintCompute.setIVec2("paintOrigin", centreX - BRUSH_RADIUS, centreY - BRUSH_RADIUS);
+    paintCompute.dispatch((brushSize + 15) / 16, (brushSize + 15) / 16, 1);
+}
+
+void clearStampBuffers(GLuint claimBuffer, GLuint movedBuffer)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, claimBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, movedBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+//reads the dirty tile count once the GPU has finished the copy, then, if this frame ran ticks, starts
+//the next copy and resets the counter. idleness is judged per tick: a frame without ticks recolours
+//nothing, so its count is left to carry over into the next frame that ticks rather than reporting a
+//busy scene as idle. sceneIdle reflects the GPU's work from at least one frame earlier, so it is late
+//both ways: settling is noticed a frame or more after it happens, and so is the first change after
+//the scene went idle. the main loop covers the second case by forcing a present on input that can
+//wake the scene (painting, switching mode)
+void updateIdleState(GLsync& dirtyFence, GLuint dirtyTileBuffer, GLuint dirtyReadbackBuffer, bool ranTicks, bool& sceneIdle)
 {
-    GLuint temp = gridBuffer;
-    gridBuffer = nextGridBuffer;
-    nextGridBuffer = temp;
+    if (dirtyFence)
+    {
+        if (glClientWaitSync(dirtyFence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            return;
+        }
+        glDeleteSync(dirtyFence);
+        dirtyFence = nullptr;
+
+        uint32_t dirtyTiles {0};
+        glBindBuffer(GL_COPY_WRITE_BUFFER, dirtyReadbackBuffer);
+        glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(uint32_t), &dirtyTiles);
+        sceneIdle = dirtyTiles == 0;
+    }
+
+    if (!ranTicks)
+    {
+        return;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, dirtyTileBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, dirtyReadbackBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(uint32_t));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, dirtyTileBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    dirtyFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+//the grid has to fit in a texture and in a shader storage block, and the indirect dispatches over the
+//active tile and live cell lists, which are 1D with up to one workgroup per tile, have to stay in range
+bool checkGridLimits(const Config& config)
+{
+    GLint maxTextureSize, maxBlockSize, maxWorkGroupsX;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    glGetIntegerv(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockSize);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxWorkGroupsX);
+
+    //the colour image is padded to whole tiles
+    int paddedWidth = (config.gridWidth + 15) / 16 * 16;
+    int paddedHeight = (config.gridHeight + 15) / 16 * 16;
+    if (paddedWidth > maxTextureSize || paddedHeight > maxTextureSize)
+    {
+        std::cerr << "ERROR: grid " << config.gridWidth << "x" << config.gridHeight << " is larger than the maximum texture size " << maxTextureSize << std::endl;
+        return false;
+    }
+    long long tiles = (long long)((config.gridWidth + 15) / 16) * ((config.gridHeight + 15) / 16);
+    if (tiles * TILE_CELLS * (long long)sizeof(Cell) > maxBlockSize)
+    {
+        std::cerr << "ERROR: grid " << config.gridWidth << "x" << config.gridHeight << " needs more than the maximum shader storage block size " << maxBlockSize << std::endl;
+        return false;
+    }
+    if (tiles > maxWorkGroupsX)
+    {
+        std::cerr << "ERROR: grid " << config.gridWidth << "x" << config.gridHeight << " has " << tiles << " tiles, more than the maximum workgroup count " << maxWorkGroupsX << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//mirror of cellIndex in grid.glsl: tiles in row order, Morton order within each tile
+uint32_t gridCellIndex(int x, int y, int tilesX)
+{
+    uint32_t local {0};
+    for (int bit = 0; bit < 4; bit++)
+    {
+        local |= ((x >> bit) & 1) << (2 * bit);
+        local |= ((y >> bit) & 1) << (2 * bit + 1);
+    }
+    return (uint32_t)((y / 16) * tilesX + x / 16) * TILE_CELLS + local;
+}
+
+//the grid as an r32ui image at grid resolution, filled from cells in row order
+GLuint createGridTexture(const Config& config, const std::vector<Cell>& cells)
+{
+    GLuint gridTexture;
+    glGenTextures(1, &gridTexture);
+    glBindTexture(GL_TEXTURE_2D, gridTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, config.gridWidth, config.gridHeight);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, config.gridWidth, config.gridHeight, GL_RED_INTEGER, GL_UNSIGNED_INT, cells.data());
+    return gridTexture;
+}
+
+//times the multi-pass kernel with the grid in a buffer and in an image, starting from the same
+//random scene. every cell gets an invocation in every pass (no live cell list), so both storages
+//do the same work however quickly the scene settles. which one wins depends on the GPU
+void runStorageBenchmark(const Config& config)
+{
+    int tilesX = (config.gridWidth + 15) / 16;
+    int tilesY = (config.gridHeight + 15) / 16;
+    int numTiles {tilesX * tilesY};
+    int gridCells {numTiles * TILE_CELLS};
+
+    //sand and water over air from a fixed seed, so every run starts from the same scene
+    std::mt19937 random(1);
+    std::vector<Cell> scene(config.gridWidth * config.gridHeight);
+    for (Cell& cell : scene)
+    {
+        uint32_t roll = random() % 10;
+        uint32_t material = roll < 3 ? MATERIAL_SAND : roll < 6 ? MATERIAL_WATER : MATERIAL_AIR;
+        cell = material == MATERIAL_AIR ? 0 : material | ((random() & 0xFF) << 16);
+    }
+
+    GLuint materialBuffer = createMaterialBuffer();
+    GLuint paramsBuffer = createSimulationParamsBuffer();
+
+    GLuint claimBuffer, movedBuffer, tileStampBuffer;
+    glGenBuffers(1, &claimBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, claimBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, gridCells / 16 * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &movedBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, movedBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, gridCells / 16 * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &tileStampBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileStampBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, numTiles * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, claimBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, movedBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, tileStampBuffer);
+
+    //a GPU timestamp either side of the ticks
+    GLuint timerQueries[2];
+    glGenQueries(2, timerQueries);
+
+    std::cout << "Benchmarking " << config.benchmarkTicks << " ticks on " << glGetString(GL_RENDERER) << std::endl;
+
+    const char* const storageNames[2] = {"buffer", "image"};
+    for (int storage = 0; storage < 2; storage++)
+    {
+        bool image = storage == 1;
+        std::vector<Shader> automataPasses = buildPassPrograms("computeShader.glsl", image ? std::vector<std::string> {"GRID_IMAGE"} : std::vector<std::string> {});
+
+        GLuint gridBuffer {0}, gridTexture {0};
+        if (image)
+        {
+            gridTexture = createGridTexture(config, scene);
+            glBindImageTexture(GRID_IMAGE_UNIT, gridTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+        }
+        else
+        {
+            std::vector<Cell> cells(gridCells, 0);
+            for (int y = 0; y < config.gridHeight; y++)
+            {
+                for (int x = 0; x < config.gridWidth; x++)
+                {
+                    cells[gridCellIndex(x, y, tilesX)] = scene[y * config.gridWidth + x];
+                }
+            }
+            glGenBuffers(1, &gridBuffer);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, gridCells * sizeof(Cell), cells.data(), GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gridBuffer);
+        }
+
+        clearStampBuffers(claimBuffer, movedBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileStampBuffer);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+        for (Shader& automataCompute : automataPasses)
+        {
+            automataCompute.use();
+            automataCompute.setBool("liveCellsOnly", false);
+        }
+
+        glQueryCounter(timerQueries[0], GL_TIMESTAMP);
+        uint32_t tick {0};
+        for (int t = 0; t < config.benchmarkTicks; t++)
+        {
+            tick++;
+            if ((tick & 0xFFFF) == 0)
+            {
+                clearStampBuffers(claimBuffer, movedBuffer);
+                tick++;
+            }
+
+            SimulationParams simulationParams {config.gridWidth, config.gridHeight, tick, 0, 0, BRUSH_RADIUS, false, false};
+            updateSimulationParams(paramsBuffer, simulationParams);
+            for (Shader& automataCompute : automataPasses)
+            {
+                automataCompute.use();
+                automataCompute.dispatch(tilesX, tilesY, 1);
+            }
+        }
+        glQueryCounter(timerQueries[1], GL_TIMESTAMP);
+
+        //waits for the GPU to finish the run
+        GLuint64 start {0}, end {0};
+        glGetQueryObjectui64v(timerQueries[0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(timerQueries[1], GL_QUERY_RESULT, &end);
+        std::cout << "Grid storage " << storageNames[storage] << ": " << (end - start) / 1e6 / config.benchmarkTicks << " ms/tick" << std::endl;
+
+        glDeleteBuffers(1, &gridBuffer);
+        glDeleteTextures(1, &gridTexture);
+        for (Shader& automataCompute : automataPasses)
+        {
+            glDeleteProgram(automataCompute.ID);
+        }
+    }
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gridBuffer);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, nextGridBuffer);
+    glDeleteQueries(2, timerQueries);
+    glDeleteBuffers(1, &claimBuffer);
+    glDeleteBuffers(1, &movedBuffer);
+    glDeleteBuffers(1, &tileStampBuffer);
+    glDeleteBuffers(1, &materialBuffer);
+    glDeleteBuffers(1, &paramsBuffer);
 }
 
 void checkOpenGLError()
@@ -0,0 +1,57 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <glad.h>
+
+//mirrored in assets/shaders/materials.glsl, uploaded once as a std140 uniform block
+int constexpr MAX_MATERIALS {256};
+int constexpr MATERIAL_BINDING {0};
+
+enum MaterialID
+{
+    MATERIAL_AIR = 0,
+    MATERIAL_SAND = 1,
+    MATERIAL_WATER = 2,
+    MATERIAL_COUNT
+};
+
+enum MovementClass
+{
+    MOVEMENT_STATIC = 0,
+    MOVEMENT_POWDER = 1,
+    MOVEMENT_LIQUID = 2
+};
+
+enum MaterialFlags
+{
+    MATERIAL_FLAG_VARIATION = 1 << 0 //per-cell brightness variation from the cell's seed
+};
+
+struct Material
+{
+    float colour[4];
+    int density;
+    int movement;
+    int flags;
+    int padding;
+};
+
+static const Material materialTable[MATERIAL_COUNT] = {
+    //colour                    density  movement         flags                     padding
+    {{0.0f, 0.0f, 0.0f, 0.0f},  0,       MOVEMENT_STATIC, 0,                        0},  //air
+    {{1.0f, 1.0f, 0.0f, 1.0f},  10,      MOVEMENT_POWDER, MATERIAL_FLAG_VARIATION,  0},  //sand
+    {{0.0f, 0.0f, 1.0f, 1.0f},  5,       MOVEMENT_LIQUID, MATERIAL_FLAG_VARIATION,  0}   //water
+};
+
+inline GLuint createMaterialBuffer()
+{
+    GLuint materialBuffer;
+    glGenBuffers(1, &materialBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, materialBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * sizeof(Material), nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(materialTable), materialTable);
+    glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BINDING, materialBuffer);
+    return materialBuffer;
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef GPU_TIMERS_H
+#define GPU_TIMERS_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <glad.h>
+
+//GPU time spent in named sections of a frame. each section is bracketed by a pair of timestamp
+//queries (timestamps rather than GL_TIME_ELAPSED, so sections may follow each other freely) and the
+//results are read FRAMES_IN_FLIGHT frames later, when the GPU is long done with them, so the CPU
+//never waits. a section that runs several times in a frame, e.g. once per tick, is summed
+class GpuTimers
+{
+public:
+    static constexpr int FRAMES_IN_FLIGHT {4};
+
+    //windowFrames is how many frames of each section the statistics cover
+    GpuTimers(const std::vector<std::string>& sectionNames, int windowFrames)
+    {
+        this->sectionNames = sectionNames;
+        this->windowFrames = windowFrames;
+        samples.resize(sectionNames.size());
+        nextSample.resize(sectionNames.size(), 0);
+        openQuery.resize(sectionNames.size(), 0);
+        frameTotals.resize(sectionNames.size());
+    }
+
+    GpuTimers(const GpuTimers&) = delete;
+    GpuTimers& operator=(const GpuTimers&) = delete;
+
+    //deletes the queries and turns the timers off. has to be called while the GL context is still
+    //current, the timers usually outlive it
+    void release()
+    {
+        setEnabled(false);
+        for (FrameSlot& slot : slots)
+        {
+            if (!slot.queries.empty())
+            {
+                glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+            }
+            slot.queries.clear();
+            slot.usedQueries = 0;
+        }
+    }
+
+    //turning the timers off drops the frames still in flight and the statistics
+    void setEnabled(bool enabled)
+    {
+        this->enabled = enabled;
+        for (FrameSlot& slot : slots)
+        {
+            slot.spans.clear();
+            slot.pending = false;
+        }
+        for (std::vector<double>& section : samples)
+        {
+            section.clear();
+        }
+        std::fill(nextSample.begin(), nextSample.end(), 0);
+    }
+
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    //collects the frame recorded in this slot FRAMES_IN_FLIGHT frames ago. if the GPU somehow hasn't
+    //finished it yet, this frame isn't timed rather than waiting
+    void beginFrame()
+    {
+        recording = false;
+        if (!enabled)
+        {
+            return;
+        }
+
+        frame = (frame + 1) % FRAMES_IN_FLIGHT;
+        FrameSlot& slot = slots[frame];
+        if (slot.pending)
+        {
+            GLint available {0};
+            glGetQueryObjectiv(slot.spans.back().end, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                return;
+            }
+            collect(slot);
+        }
+
+        slot.spans.clear();
+        slot.usedQueries = 0;
+        recording = true;
+    }
+
+    void begin(int section)
+    {
+        if (recording)
+        {
+            openQuery[section] = nextQuery();
+            glQueryCounter(openQuery[section], GL_TIMESTAMP);
+        }
+    }
+
+    void end(int section)
+    {
+        if (recording)
+        {
+            GLuint query = nextQuery();
+            glQueryCounter(query, GL_TIMESTAMP);
+            slots[frame].spans.push_back({section, openQuery[section], query});
+        }
+    }
+
+    void endFrame()
+    {
+        if (recording)
+        {
+            slots[frame].pending = !slots[frame].spans.empty();
+        }
+    }
+
+    //rolling average, median, 95th percentile and worst of each section that ran in the window
+    void print() const
+    {
+        std::cout << "GPU ms per frame      avg     p50     p95     max" << std::endl;
+        for (size_t section = 0; section < sectionNames.size(); section++)
+        {
+            if (samples[section].empty())
+            {
+                continue;
+            }
+
+            std::vector<double> sorted = samples[section];
+            std::sort(sorted.begin(), sorted.end());
+            double average {0.0};
+            for (double sample : sorted)
+            {
+                average += sample;
+            }
+            average /= sorted.size();
+
+            std::cout << "  " << std::left << std::setw(14) << sectionNames[section] << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(8) << average
+                      << std::setw(8) << percentile(sorted, 0.5)
+                      << std::setw(8) << percentile(sorted, 0.95)
+                      << std::setw(8) << sorted.back() << std::endl;
+        }
+        std::cout << std::defaultfloat;
+    }
+
+private:
+    struct Span
+    {
+        int section;
+        GLuint start;
+        GLuint end;
+    };
+
+    struct FrameSlot
+    {
+        std::vector<GLuint> queries;
+        size_t usedQueries {0};
+        std::vector<Span> spans;
+        bool pending {false};
+    };
+
+    std::vector<std::string> sectionNames;
+    int windowFrames;
+    bool enabled {false};
+    bool recording {false};
+
+    FrameSlot slots[FRAMES_IN_FLIGHT];
+    int frame {0};
+    std::vector<GLuint> openQuery;
+
+    //per section ring of the last windowFrames per-frame totals, in milliseconds
+    std::vector<std::vector<double>> samples;
+    std::vector<size_t> nextSample;
+    std::vector<double> frameTotals;
+
+    //queries are kept per slot and reused, the pool only grows when a frame times more sections than before
+    GLuint nextQuery()
+    {
+        FrameSlot& slot = slots[frame];
+        if (slot.usedQueries == slot.queries.size())
+        {
+            GLuint query;
+            glGenQueries(1, &query);
+            slot.queries.push_back(query);
+        }
+        return slot.queries[slot.usedQueries++];
+    }
+
+    void collect(FrameSlot& slot)
+    {
+        std::vector<bool> ran(sectionNames.size(), false);
+        std::fill(frameTotals.begin(), frameTotals.end(), 0.0);
+        for (const Span& span : slot.spans)
+        {
+            GLuint64 start {0}, end {0};
+            glGetQueryObjectui64v(span.start, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(span.end, GL_QUERY_RESULT, &end);
+            frameTotals[span.section] += (end - start) / 1e6;
+            ran[span.section] = true;
+        }
+        slot.pending = false;
+
+        for (size_t section = 0; section < sectionNames.size(); section++)
+        {
+            if (!ran[section])
+            {
+                continue;
+            }
+            if ((int)samples[section].size() < windowFrames)
+            {
+                samples[section].push_back(frameTotals[section]);
+            }
+            else
+            {
+                samples[section][nextSample[section]] = frameTotals[section];
+            }
+            nextSample[section] = (nextSample[section] + 1) % windowFrames;
+        }
+    }
+
+    static double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        return sorted[std::min(sorted.size() - 1, (size_t)(fraction * (sorted.size() - 1) + 0.5))];
+    }
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef EMBEDDED_SHADERS_H
+#define EMBEDDED_SHADERS_H
+
+#include <cstddef>
+#include <string>
+
+//the files of assets/shaders compiled into the executable, generated at build time by
+//cmake/EmbedShaders.cmake, so the program doesn't depend on its working directory
+struct EmbeddedShader
+{
+    const char* name;
+    const char* source;
+    size_t length;
+};
+
+extern const EmbeddedShader embeddedShaders[];
+extern const size_t embeddedShaderCount;
+
+//nullptr if no shader file of that name was embedded
+inline const EmbeddedShader* findEmbeddedShader(const std::string& name)
+{
+    for (size_t i = 0; i < embeddedShaderCount; i++)
+    {
+        if (name == embeddedShaders[i].name)
+        {
+            return &embeddedShaders[i];
+        }
+    }
+    return nullptr;
+}
+
+#endif
@@ -5,129 +5,407 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <iterator>
+#include <cstdio>
+#include <cstdint>
 #include <glad.h>
+#include "EmbeddedShaders.h"
 
 class Shader
 {
 public:
     GLuint ID;
 
-    Shader(const char* vertexPath, const char* fragmentPath)
-    {
-        std::string vertexCode, fragmentCode;
-        std::ifstream vShaderFile, fShaderFile;
+    //directory shader files are read from at run time, for editing them without rebuilding. empty
+    //uses the copies embedded in the executable
+    static inline std::string sourceDirectory;
 
-        vShaderFile.exceptions(std::ifstream::failbit);
-        fShaderFile.exceptions(std::ifstream::failbit);
-        try
-        {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
+    //directory for linked program binaries, empty to always compile from source. see loadProgramBinary.
+    //it is only set on request (--shader-cache), so by default building shaders touches no files at all
+    static inline std::string binaryCacheDirectory;
 
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
+    //shaders are named by their file name in assets/shaders. defines are "NAME" or "NAME VALUE", added as #define lines after each stage's #version line
+    Shader(const char* vertexName, const char* fragmentName, const std::vector<std::string>& defines = {})
+    {
+        stageFiles = {{GL_VERTEX_SHADER, "VERTEX", vertexName}, {GL_FRAGMENT_SHADER, "FRAGMENT", fragmentName}};
+        this->defines = defines;
+        std::vector<Stage> stages = readStages();
+        sourceHash = hashStages(stages);
+        ID = buildProgram(stages);
+        cacheUniformLocations();
+    }
 
-            vShaderFile.close();
-            fShaderFile.close();
+    Shader(const char* computeName, const std::vector<std::string>& defines = {})
+    {
+        stageFiles = {{GL_COMPUTE_SHADER, "COMPUTE", computeName}};
+        this->defines = defines;
+        std::vector<Stage> stages = readStages();
+        sourceHash = hashStages(stages);
+        ID = buildProgram(stages);
+        cacheUniformLocations();
+    }
+
+    enum ReloadResult
+    {
+        RELOAD_UNCHANGED,
+        RELOAD_REBUILT,
+        RELOAD_FAILED
+    };
 
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+    //rebuilds the program if its expanded sources changed since it was last built. if they don't
+    //compile or link the errors are reported and the previous program stays in use, so a broken edit
+    //never stops the simulation. plain uniforms start out at zero again, the caller sets them before
+    //every use anyway
+    ReloadResult reload()
+    {
+        std::vector<Stage> stages = readStages();
+        uint64_t hash = hashStages(stages);
+        if (hash == sourceHash)
+        {
+            return RELOAD_UNCHANGED;
         }
-        catch(std::ifstream::failure& e)
+
+        GLuint program = buildProgram(stages);
+        GLint linked {0};
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
         {
-            std::cerr << "ERROR: Shader file failed to read" << e.what() << std::endl;
+            glDeleteProgram(program);
+            return RELOAD_FAILED;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
 
-        unsigned int vertex, fragment;
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, nullptr);
-        glCompileShader(vertex);
-        checkCompileError(vertex, "VERTEX");
+        glDeleteProgram(ID);
+        ID = program;
+        sourceHash = hash;
+        cacheUniformLocations();
+        return RELOAD_REBUILT;
+    }
 
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, nullptr);
-        glCompileShader(fragment);
-        checkCompileError(fragment, "FRAGMENT");
+    void use()
+    {
+        glUseProgram(ID);
+    }
 
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileError(ID, "PROGRAM");
+    void dispatch(int x, int y, int z)
+    {
+        glDispatchCompute(x, y, z);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
 
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    //workgroup counts are read from the buffer bound to GL_DISPATCH_INDIRECT_BUFFER
+    void dispatchIndirect(GLintptr offset)
+    {
+        glDispatchComputeIndirect(offset);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
     }
 
-    Shader(const char* computePath)
+    void setBool(const std::string &name, bool value)
+    {
+        glUniform1i(uniformLocation(name), (int)value);
+    }
+    void setInt(const std::string &name, int value)
     {
-        std::string computeCode;
-        std::ifstream cShaderFile;
+        glUniform1i(uniformLocation(name), value);
+    }
+    void setUint(const std::string &name, unsigned int value)
+    {
+        glUniform1ui(uniformLocation(name), value);
+    }
+    void setIVec2(const std::string &name, int x, int y)
+    {
+        glUniform2i(uniformLocation(name), x, y);
+    }
+    void setFloat(const std::string &name, float value)
+    {
+        glUniform1f(uniformLocation(name), value);
+    }
+    void setVec2(const std::string &name, float x, float y)
+    {
+        glUniform2f(uniformLocation(name), x, y);
+    }
+
+    //image and sampler units are fixed by layout(binding = N) in the shaders, so only the texture is bound
+    static void bindImage2D(GLuint unit, GLuint textureID, GLenum access = GL_READ_WRITE, GLint level = 0)
+    {
+        glBindImageTexture(unit, textureID, level, GL_FALSE, 0, access, GL_RGBA8);
+    }
+
+    //-1 for names the program doesn't use, which glUniform* ignores like an unknown name
+    GLint uniformLocation(const std::string& name) const
+    {
+        auto found = uniformLocations.find(name);
+        return found != uniformLocations.end() ? found->second : -1;
+    }
+
+private:
+    struct Stage
+    {
+        GLenum type;
+        const char* name;
+        std::string source;
+    };
+
+    struct StageFile
+    {
+        GLenum type;
+        const char* name;
+        std::string fileName;
+    };
+
+    //what the program is built from, kept for reload, and the hash of the sources it was last built
+    //from, so reload can tell whether an edit touched this program at all
+    std::vector<StageFile> stageFiles;
+    std::vector<std::string> defines;
+    uint64_t sourceHash {0};
+
+    std::vector<Stage> readStages() const
+    {
+        std::vector<Stage> stages;
+        for (const StageFile& file : stageFiles)
+        {
+            stages.push_back({file.type, file.name, injectDefines(readSource(file.fileName), defines)});
+        }
+        return stages;
+    }
 
-        cShaderFile.exceptions(std::ifstream::failbit);
-        try
+    //links a program from a cached binary if there is a usable one, otherwise from source. a failed
+    //compile or link is reported and still returns the (unlinked) program
+    GLuint buildProgram(const std::vector<Stage>& stages)
+    {
+        std::string binaryPath = programBinaryPath(stages);
+        GLuint program = glCreateProgram();
+        if (!binaryPath.empty())
         {
-            cShaderFile.open(computePath);
-            std::stringstream cShaderStream;
-            cShaderStream << cShaderFile.rdbuf();
-            cShaderFile.close();
-            computeCode = cShaderStream.str();
+            if (loadProgramBinary(program, binaryPath))
+            {
+                return program;
+            }
+            //start again from an untouched program object
+            glDeleteProgram(program);
+            program = glCreateProgram();
         }
-        catch(std::ifstream::failure& e)
+
+        std::vector<GLuint> shaders;
+        for (const Stage& stage : stages)
         {
-            std::cerr << "ERROR: Compute shader file failed to read: " << e.what() << std::endl;
+            const char* code = stage.source.c_str();
+            GLuint shader = glCreateShader(stage.type);
+            glShaderSource(shader, 1, &code, nullptr);
+            glCompileShader(shader);
+            checkCompileError(shader, stage.name);
+            glAttachShader(program, shader);
+            shaders.push_back(shader);
         }
 
-        const char* cShaderCode = computeCode.c_str();
+        //only ask the driver to keep a retrievable binary when it is going to be saved
+        if (!binaryPath.empty())
+        {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(program);
+        if (checkCompileError(program, "PROGRAM") && !binaryPath.empty())
+        {
+            saveProgramBinary(program, binaryPath);
+        }
 
-        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
-        glShaderSource(compute, 1, &cShaderCode, nullptr);
-        glCompileShader(compute);
-        checkCompileError(compute, "COMPUTE");
+        for (GLuint shader : shaders)
+        {
+            glDetachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        return program;
+    }
 
-        ID = glCreateProgram();
-        glAttachShader(ID, compute);
-        glLinkProgram(ID);
-        checkCompileError(ID, "PROGRAM");
+    static uint64_t hashText(const std::string& text, uint64_t hash)
+    {
+        //FNV-1a
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
 
-        glDeleteShader(compute);
+    //the expanded sources, which include the injected defines
+    static uint64_t hashStages(const std::vector<Stage>& stages)
+    {
+        uint64_t hash {14695981039346656037ull};
+        for (const Stage& stage : stages)
+        {
+            hash = hashText(std::string(stage.name) + "\n" + stage.source, hash);
+        }
+        return hash;
     }
 
-    void use()
+    //the cache file for these stages on this driver. the key covers the expanded sources, which include
+    //the injected defines, and the driver's vendor, renderer and version strings, so editing a shader,
+    //changing a define or updating the driver all miss the cache rather than loading a stale binary
+    static std::string programBinaryPath(const std::vector<Stage>& stages)
     {
-        glUseProgram(ID);
+        GLint formats {0};
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (binaryCacheDirectory.empty() || formats == 0)
+        {
+            return "";
+        }
+
+        uint64_t hash = hashStages(stages);
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+        {
+            hash = hashText((const char*)glGetString(name), hash);
+        }
+
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "%016llx.bin", (unsigned long long)hash);
+        return binaryCacheDirectory + "/" + fileName;
     }
 
-    void dispatch(int x, int y, int z)
+    //the file holds the binary format followed by the binary. the driver may still reject a binary
+    //that matches the key, in which case the caller compiles from source and overwrites it
+    static bool loadProgramBinary(GLuint program, const std::string& path)
     {
-        glDispatchCompute(x, y, z);
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        std::ifstream file(path, std::ios::binary);
+        GLenum format;
+        if (!file.read((char*)&format, sizeof(format)))
+        {
+            return false;
+        }
+        std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+        GLint success {0};
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success;
     }
 
-    void setBool(const std::string &name, bool value)
+    static void saveProgramBinary(GLuint program, const std::string& path)
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        GLint length {0};
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length == 0)
+        {
+            return;
+        }
+
+        std::vector<char> binary(length);
+        GLenum format;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        //the cache is only an optimisation, so a directory that can't be created or written is skipped quietly
+        std::error_code error;
+        std::filesystem::create_directories(binaryCacheDirectory, error);
+        if (error)
+        {
+            return;
+        }
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write((const char*)&format, sizeof(format)) || !file.write(binary.data(), length))
+        {
+            file.close();
+            std::filesystem::remove(path, error);
+        }
     }
-    void setInt(const std::string &name, int value)
+
+    //resolved once after linking, so setting a uniform never asks the driver for a location
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    void cacheUniformLocations()
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        uniformLocations.clear();
+        GLint uniformCount {0}, maxNameLength {0};
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::vector<char> name(maxNameLength + 1);
+        for (GLint i = 0; i < uniformCount; i++)
+        {
+            GLsizei length;
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(ID, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+            //members of uniform blocks are active uniforms too, but have no location
+            GLint location = glGetUniformLocation(ID, name.data());
+            if (location >= 0)
+            {
+                uniformLocations[std::string(name.data(), length)] = location;
+            }
+        }
     }
-    void setFloat(const std::string &name, float value)
+
+    //reads a shader from the embedded copies or sourceDirectory, expanding #include "file" lines
+    static std::string readSource(const std::string& name)
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        std::stringstream shaderStream;
+        if (sourceDirectory.empty())
+        {
+            const EmbeddedShader* embedded = findEmbeddedShader(name);
+            if (!embedded)
+            {
+                std::cerr << "ERROR: Shader not embedded: " << name << std::endl;
+                return "";
+            }
+            shaderStream.write(embedded->source, embedded->length);
+        }
+        else
+        {
+            std::string path = sourceDirectory + "/" + name;
+            std::ifstream shaderFile;
+
+            shaderFile.exceptions(std::ifstream::failbit);
+            try
+            {
+                shaderFile.open(path);
+                shaderStream << shaderFile.rdbuf();
+                shaderFile.close();
+            }
+            catch(std::ifstream::failure& e)
+            {
+                std::cerr << "ERROR: Shader file failed to read: " << path << " " << e.what() << std::endl;
+                return "";
+            }
+        }
+
+        std::string source, line;
+        while (std::getline(shaderStream, line))
+        {
+            if (line.rfind("#include", 0) == 0)
+            {
+                size_t first = line.find('"');
+                size_t last = line.find_last_of('"');
+                source += readSource(line.substr(first + 1, last - first - 1));
+            }
+            else
+            {
+                source += line + "\n";
+            }
+        }
+        return source;
     }
-    void setImage2D(const std::string &name, GLuint textureID, GLenum access = GL_READ_WRITE)
+
+    //#version has to stay the first line, so the defines go straight after it
+    static std::string injectDefines(const std::string& source, const std::vector<std::string>& defines)
     {
-        GLint loc = glGetUniformLocation(ID, name.c_str());
-        glUniform1i(loc, 0);
-        glBindImageTexture(0, textureID, 0, GL_FALSE, 0, access, GL_RGBA8);
+        if (defines.empty())
+        {
+            return source;
+        }
+
+        std::string block;
+        for (const std::string& define : defines)
+        {
+            block += "#define " + define + "\n";
+        }
+
+        size_t versionEnd = source.rfind("#version", 0) == 0 ? source.find('\n') + 1 : 0;
+        return source.substr(0, versionEnd) + block + source.substr(versionEnd);
     }
 
-private:
-    void checkCompileError(unsigned int shader, std::string type)
+    bool checkCompileError(unsigned int shader, std::string type)
     {
         int success;
         char infolog[1024];
@@ -150,6 +428,7 @@ private:
                 std::cerr << "ERROR: Shader compilation of type: " << type << "\n" << infolog << std::endl;
             }
         }
+        return success;
     }
 };
 
@@ -0,0 +1,81 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <string>
+#include <iostream>
+#include "EmbeddedShaders.h"
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//watches a shader directory for files that were saved or replaced, so the programs can be rebuilt
+//while the simulation keeps running. uses inotify, on other platforms nothing is ever reported
+class ShaderWatcher
+{
+public:
+    //an empty directory watches nothing
+    ShaderWatcher(const std::string& directory)
+    {
+#ifdef __linux__
+        if (directory.empty())
+        {
+            return;
+        }
+
+        //editors either rewrite a file in place or write a temporary one and rename it over the original
+        watchFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watchFD < 0 || inotify_add_watch(watchFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            std::cerr << "ERROR: Shader directory can't be watched: " << directory << std::endl;
+        }
+#endif
+    }
+
+    ~ShaderWatcher()
+    {
+#ifdef __linux__
+        if (watchFD >= 0)
+        {
+            close(watchFD);
+        }
+#endif
+    }
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    //true if a shader file changed since the last call, never blocks. other files, like the
+    //temporaries editors write next to the one being saved, are ignored
+    bool poll()
+    {
+        bool changed {false};
+#ifdef __linux__
+        if (watchFD < 0)
+        {
+            return false;
+        }
+
+        alignas(inotify_event) char events[4096];
+        ssize_t length;
+        while ((length = read(watchFD, events, sizeof(events))) > 0)
+        {
+            for (ssize_t offset = 0; offset < length; )
+            {
+                const inotify_event* event = (const inotify_event*)(events + offset);
+                if (event->len > 0 && findEmbeddedShader(event->name))
+                {
+                    changed = true;
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+#endif
+        return changed;
+    }
+
+private:
+    int watchFD {-1};
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <SDL3/SDL.h>
+
+//fixed timestep clock: real time is accumulated every frame and spent in whole ticks, so the
+//simulation runs at tickRate regardless of how fast frames are presented
+class SimulationClock
+{
+public:
+    SimulationClock(double tickRate, int maxTicksPerFrame)
+    {
+        setTickRate(tickRate);
+        this->maxTicksPerFrame = maxTicksPerFrame;
+        lastCounter = SDL_GetPerformanceCounter();
+    }
+
+    void setTickRate(double tickRate)
+    {
+        this->tickRate = tickRate;
+        tickSeconds = 1.0 / tickRate;
+    }
+
+    double getTickRate() const
+    {
+        return tickRate;
+    }
+
+    //number of ticks due since the last call. when the machine can't keep up the backlog is
+    //dropped after maxTicksPerFrame, so the simulation slows down instead of spiralling
+    int advance()
+    {
+        Uint64 counter = SDL_GetPerformanceCounter();
+        accumulator += (double)(counter - lastCounter) / (double)SDL_GetPerformanceFrequency();
+        lastCounter = counter;
+
+        int ticks = (int)(accumulator / tickSeconds);
+        if (ticks > maxTicksPerFrame)
+        {
+            ticks = maxTicksPerFrame;
+            accumulator = 0.0;
+        }
+        else
+        {
+            accumulator -= ticks * tickSeconds;
+        }
+        return ticks;
+    }
+
+    //time left until the next tick is due, for sleeping when there is nothing to present
+    Uint64 nanosecondsUntilNextTick() const
+    {
+        double elapsed = (double)(SDL_GetPerformanceCounter() - lastCounter) / (double)SDL_GetPerformanceFrequency();
+        double remaining = tickSeconds - accumulator - elapsed;
+        return remaining > 0.0 ? (Uint64)(remaining * 1e9) : 0;
+    }
+
+private:
+    double tickRate;
+    double tickSeconds;
+    int maxTicksPerFrame;
+
+    double accumulator {0.0};
+    Uint64 lastCounter;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SIMULATION_PARAMS_H
+#define SIMULATION_PARAMS_H
+
+#include <cstdint>
+#include <glad.h>
+
+//mirrored in assets/shaders/simulationParams.glsl, a std140 uniform block rewritten once per tick
+int constexpr SIMULATION_PARAMS_BINDING {1};
+
+struct SimulationParams
+{
+    int32_t gridWidth;
+    int32_t gridHeight;
+    uint32_t tick;
+    int32_t mouseX;
+    int32_t mouseY;
+    int32_t brushRadius;
+    //std140 bools are 4 bytes
+    uint32_t leftMouseDown;
+    uint32_t rightMouseDown;
+};
+
+inline GLuint createSimulationParamsBuffer()
+{
+    GLuint paramsBuffer;
+    glGenBuffers(1, &paramsBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, paramsBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(SimulationParams), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SIMULATION_PARAMS_BINDING, paramsBuffer);
+    return paramsBuffer;
+}
+
+//the whole block in one write, seen by every dispatch and draw issued after it
+inline void updateSimulationParams(GLuint paramsBuffer, const SimulationParams& params)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, paramsBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SimulationParams), &params);
+}
+
+#endif